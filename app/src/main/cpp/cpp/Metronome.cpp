@@ -1,3 +1,6 @@
+#include <algorithm>
+#include <cstdlib>
+#include <ctime>
 #include <thread>
 
 #include "utils/Logging.h"
@@ -5,81 +8,633 @@
 #include "Metronome.h"
 #include "audio/AAssetDataSource.h"
 
-Metronome::Metronome(AAssetManager &assetManager) : mAssetManager(assetManager) {
+constexpr size_t kInitWorkerCount { 4 };
+constexpr int64_t kMinUiWaitMs { 2 };
+constexpr int64_t kMaxUiWaitMs { 250 };
+constexpr int64_t kNanosPerSecond { 1000000000 };
+// Enough for a whole power saving callback, which the input must be able to buffer too
+constexpr int32_t kMaxInputFrames { 2 * kPowerSavingFramesPerCallback };
+// How often and for how long the init thread looks for the first callback after starting
+constexpr std::chrono::milliseconds kFirstCallbackPollInterval { 5 };
+constexpr int64_t kMaxFirstCallbackWaitUs { 2000000 };
+// Anything larger means the timestamps cannot be trusted, the phase is then left as estimated
+constexpr int64_t kMaxPhaseCorrectionFrames { kSampleRate };
+
+namespace {
+
+struct PhaseResult {
+    bool isSuccessful;
+    int64_t durationUs;
+};
+
+template<typename Phase>
+PhaseResult runPhase(Phase phase) {
+    auto start = std::chrono::steady_clock::now();
+    bool isSuccessful = phase();
+    return {isSuccessful, elapsedMicros(start)};
+}
+
+// The clock the stream timestamps are on
+int64_t monotonicNanos() {
+    timespec time{};
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return time.tv_sec * kNanosPerSecond + time.tv_nsec;
+}
+
+}
+
+Metronome::Metronome(AAssetManager &assetManager, int32_t deviceChannelCount)
+        : mAssetManager(assetManager), mDeviceChannelCount(deviceChannelCount) {
+    mSequencer.setBeatListener(&mTimingAnalyzer);
 }
 
 DataCallbackResult Metronome::onAudioReady(oboe::AudioStream *oboeStream, void *audioData,
                                            int32_t numFrames) {
 
-    mMixer.renderAudio(static_cast<float *>(audioData), numFrames);
+    if (mFirstCallbackUs.load(std::memory_order_relaxed) < 0) {
+        mFirstCallbackUs.store(elapsedMicros(mInitStartTime), std::memory_order_relaxed);
+    }
+
+    const int64_t cpuTimeStart = CallbackStats::threadCpuTimeNanos();
+
+    if (mIsPhaseAnchorPending.load(std::memory_order_acquire)) {
+        realignToPhaseAnchor(oboeStream);
+    }
+
+    // The Sequencer clock carries on across stream reopens, the stream's frame count does not
+    const int64_t outputFrameOffset =
+            mSequencer.getFramePosition() - oboeStream->getFramesWritten();
+
+    mSequencer.renderAudio(static_cast<float *>(audioData), numFrames);
+    analyzeInput(oboeStream, outputFrameOffset);
+
+    mActiveCallbackStats.load(std::memory_order_relaxed)->record(
+            CallbackStats::threadCpuTimeNanos() - cpuTimeStart);
 
     return DataCallbackResult::Continue;
 }
 
-void Metronome::init() {
+void Metronome::init(std::function<void(bool)> onReady) {
 
-    openStream();
+    if (mInitThread.joinable()) {
+        mInitThread.join();
+    }
+    if (mModeSwitchThread.joinable()) {
+        mModeSwitchThread.join();
+    }
+
+    mInitStartTime = std::chrono::steady_clock::now();
+    mFirstCallbackUs = -1;
+    {
+        std::lock_guard<std::mutex> lock(mInitMutex);
+        mIsReady = false;
+        mIsEnding = false;
+        mIsStreamLost = false;
+        mStartupMetrics = StartupMetrics();
+    }
+
+    mInitThread = std::thread([this, onReady]() { runInit(onReady); });
+}
+
+void Metronome::runInit(const std::function<void(bool)> &onReady) {
+
+    bool isPowerSaving;
+    {
+        std::lock_guard<std::mutex> lock(mInitMutex);
+        isPowerSaving = mIsPowerSavingRequested;
+    }
+
+    bool isStreamOpen;
+    bool areSourcesReady;
+    {
+        WorkerPool pool(kInitWorkerCount);
 
-    setupAudioSources();
+        std::future<PhaseResult> streamOpen = pool.submit([this, isPowerSaving]() {
+            return runPhase([this, isPowerSaving]() { return openStream(isPowerSaving); });
+        });
+
+        areSourcesReady = setupAudioSources(pool);
+
+        PhaseResult streamResult = streamOpen.get();
+        isStreamOpen = streamResult.isSuccessful;
+
+        std::lock_guard<std::mutex> lock(mInitMutex);
+        mStartupMetrics.streamOpenUs = streamResult.durationUs;
+    }
+
+    if (!isStreamOpen || !areSourcesReady) {
+        LOGE("Metronome setup failed, the audio stream will not be started");
+        if (mAudioStream) {
+            mAudioStream->close();
+            mAudioStream.reset();
+        }
+        onReady(false);
+        return;
+    }
+
+    mMixer.setChannelCount(mAudioStream->getChannelCount());
 
     Result result = mAudioStream->requestStart();
     if (result != Result::OK) {
         LOGE("Failed to start stream. Error: %s", convertToText(result));
+        onReady(false);
         return;
     }
+
+    bool isStartPending;
+    {
+        std::lock_guard<std::mutex> lock(mInitMutex);
+        mStartupMetrics.readyUs = elapsedMicros(mInitStartTime);
+        mIsReady = true;
+        mOutputChannelCount = mAudioStream->getChannelCount();
+        installBeatSounds(mIsSynthesizedClicks);
+        isStartPending = mIsStartPending;
+        mIsStartPending = false;
+
+        // The screen may have turned on or off while the stream was being opened
+        startModeSwitch();
+    }
+
+    if (isStartPending) {
+        startBeatThread();
+    }
+
+    onReady(true);
+    logStartupMetrics();
+}
+
+void Metronome::logStartupMetrics() {
+    {
+        // The audio thread never notifies, so it cannot block on the mutex, its progress is polled
+        std::unique_lock<std::mutex> lock(mInitMutex);
+        while (!mIsEnding && mFirstCallbackUs.load(std::memory_order_relaxed) < 0 &&
+               elapsedMicros(mInitStartTime) < kMaxFirstCallbackWaitUs) {
+            mInitCondition.wait_for(lock, kFirstCallbackPollInterval);
+        }
+    }
+
+    StartupMetrics metrics = getStartupMetrics();
+    LOGI("Startup metrics (us): stream open %lld, decode %lld/%lld/%lld, ready %lld, "
+         "first callback %lld",
+         (long long) metrics.streamOpenUs,
+         (long long) metrics.decodeUs[0],
+         (long long) metrics.decodeUs[1],
+         (long long) metrics.decodeUs[2],
+         (long long) metrics.readyUs,
+         (long long) metrics.firstCallbackUs);
 }
 
 void Metronome::end() {
 
+    {
+        std::lock_guard<std::mutex> lock(mInitMutex);
+        mIsEnding = true;
+    }
+    mInitCondition.notify_all();
+
+    if (mInitThread.joinable()) {
+        mInitThread.join();
+    }
+    // No switch is started once ending, and a running one stops after the current reopen
+    if (mModeSwitchThread.joinable()) {
+        mModeSwitchThread.join();
+    }
+
+    stopPlaying();
+
+    {
+        std::lock_guard<std::mutex> lock(mInitMutex);
+        mIsReady = false;
+    }
+
     if (mAudioStream) {
         mAudioStream->stop();
         mAudioStream->close();
         mAudioStream.reset();
     }
+
+    // Only closed once no callback can be reading from it
+    mAnalyzedInputStream.store(nullptr, std::memory_order_release);
+    if (mInputStream) {
+        mInputStream->stop();
+        mInputStream->close();
+        mInputStream.reset();
+    }
+}
+
+StartupMetrics Metronome::getStartupMetrics() {
+    std::lock_guard<std::mutex> lock(mInitMutex);
+    StartupMetrics metrics = mStartupMetrics;
+    metrics.firstCallbackUs = mFirstCallbackUs.load(std::memory_order_relaxed);
+    return metrics;
 }
 
-bool Metronome::openStream() {
+bool Metronome::openStream(bool isPowerSaving) {
     AudioStreamBuilder builder;
     builder.setFormat(AudioFormat::Float);
     builder.setFormatConversionAllowed(true);
-    builder.setPerformanceMode(PerformanceMode::LowLatency);
-    builder.setSharingMode(SharingMode::Exclusive);
+    if (isPowerSaving) {
+        builder.setPerformanceMode(PerformanceMode::PowerSaving);
+        builder.setSharingMode(SharingMode::Shared);
+        builder.setFramesPerDataCallback(kPowerSavingFramesPerCallback);
+    } else {
+        builder.setPerformanceMode(PerformanceMode::LowLatency);
+        builder.setSharingMode(SharingMode::Exclusive);
+    }
     builder.setSampleRate(kSampleRate);
     builder.setSampleRateConversionQuality(SampleRateConversionQuality::Medium);
-    builder.setChannelCount(kChannelCount);
+    // Every output of the device so the buses can be routed to any of them
+    const int32_t channelCount = std::max(mDeviceChannelCount, 1);
+    builder.setChannelCount(channelCount);
     builder.setDataCallback(this);
 
     Result result = builder.openStream(mAudioStream);
+    if (result != Result::OK && channelCount != kChannelCount) {
+        LOGE("Failed to open a %d channel stream, falling back to %d. Error: %s",
+             channelCount, kChannelCount, convertToText(result));
+        builder.setChannelCount(kChannelCount);
+        result = builder.openStream(mAudioStream);
+    }
     if (result != Result::OK) {
         LOGE("Failed to open stream. Error: %s", convertToText(result));
         return false;
     }
+
+    mIsStreamPowerSaving = isPowerSaving;
+    CallbackStats *callbackStats = &mCallbackStats[isPowerSaving ? 1 : 0];
+    callbackStats->reset();
+    mActiveCallbackStats.store(callbackStats, std::memory_order_relaxed);
     return true;
 }
 
-bool Metronome::setupAudioSources() {
-    if (!setupPlayerBeat(kNormalBeat, &mNormalBeatPlayer)) {
-        LOGE("Could not load source data for normal beat sound");
+Metronome::ReopenResult Metronome::reopenStream(bool isPowerSaving) {
+
+    const bool wasPowerSaving = mIsStreamPowerSaving;
+    // After a failed switch there is no stream left, and no beat phase to carry over
+    const bool hasStream = mAudioStream != nullptr;
+    int64_t anchorNanos = 0;
+    int64_t anchorFrame = 0;
+
+    if (hasStream) {
+        const CallbackStats &previousStats = getCallbackStats(mIsStreamPowerSaving);
+        LOGI("Leaving %s mode: %.1f wakeups/s, %.1f us CPU per callback",
+             mIsStreamPowerSaving ? "power saving" : "low latency",
+             previousStats.getWakeupsPerSecond(),
+             previousStats.getAverageCpuTimeMicros());
+
+        // The beat phase carries over from what is being heard right now rather than from the
+        // last rendered frame: whatever the old stream still has buffered may never be played.
+        anchorNanos = monotonicNanos();
+        int64_t presentedStreamFrame;
+        ResultWithValue<FrameTimestamp> timestamp = mAudioStream->getTimestamp(CLOCK_MONOTONIC);
+        if (timestamp) {
+            presentedStreamFrame = timestamp.value().position +
+                    (anchorNanos - timestamp.value().timestamp) * kSampleRate / kNanosPerSecond;
+        } else {
+            presentedStreamFrame =
+                    mAudioStream->getFramesWritten() - mAudioStream->getBufferSizeInFrames();
+        }
+
+        mAudioStream->stop();
+        // No callback is running from here on, the Sequencer clock can be read and moved
+        anchorFrame = presentedStreamFrame +
+                mSequencer.getFramePosition() - mAudioStream->getFramesWritten();
+        mAudioStream->close();
+        mAudioStream.reset();
+    }
+
+    ReopenResult reopenResult = ReopenResult::Switched;
+    if (!openStream(isPowerSaving)) {
+        LOGE("Could not switch performance mode, restoring the previous stream");
+        if (!openStream(wasPowerSaving)) {
+            return ReopenResult::Failed;
+        }
+        reopenResult = ReopenResult::Restored;
+    }
+
+    if (hasStream) {
+        // The first frame the new stream renders is heard once its buffer has played out, so
+        // that is where the clock has to be for the grid to stay where it would have been had
+        // the stream never stopped. The stream's own latency beyond its buffer only shows in its
+        // timestamps, the audio thread corrects for it once they are available.
+        const int64_t elapsedFrames =
+                (monotonicNanos() - anchorNanos) * kSampleRate / kNanosPerSecond;
+        mSequencer.seekTo(anchorFrame + elapsedFrames + mAudioStream->getBufferSizeInFrames());
+        mPhaseAnchorFrame = anchorFrame;
+        mPhaseAnchorNanos = anchorNanos;
+        mIsPhaseAnchorPending.store(true, std::memory_order_release);
+    }
+    mMixer.setChannelCount(mAudioStream->getChannelCount());
+
+    Result result = mAudioStream->requestStart();
+    if (result != Result::OK) {
+        LOGE("Failed to start stream. Error: %s", convertToText(result));
+        mAudioStream->close();
+        mAudioStream.reset();
+        return ReopenResult::Failed;
+    }
+    return reopenResult;
+}
+
+void Metronome::setPowerSavingMode(bool isPowerSaving) {
+    std::lock_guard<std::mutex> lock(mInitMutex);
+
+    mIsPowerSavingRequested = isPowerSaving;
+    // A stream lost to a failed switch is opened again on the next request
+    if (!mIsReady && !mIsStreamLost) return;
+
+    startModeSwitch();
+}
+
+void Metronome::startModeSwitch() {
+    // A switch under way picks up the latest request before it finishes
+    if (mIsEnding || mIsSwitchingMode) return;
+    if (!mIsStreamLost && mIsPowerSavingRequested == mIsStreamPowerSaving) return;
+    mIsSwitchingMode = true;
+
+    // The previous switch is done, all that is left of it is the thread exiting
+    if (mModeSwitchThread.joinable()) {
+        mModeSwitchThread.join();
+    }
+    mModeSwitchThread = std::thread([this]() { runModeSwitch(); });
+}
+
+void Metronome::runModeSwitch() {
+    std::unique_lock<std::mutex> lock(mInitMutex);
+
+    bool isStartPending = false;
+
+    // The stream is only touched by this thread until mIsSwitchingMode is cleared, so the lock is
+    // not held while reopening and the callers are never kept waiting on it
+    while (!mIsEnding && (mIsStreamLost || mIsPowerSavingRequested != mIsStreamPowerSaving)) {
+        const bool isPowerSaving = mIsPowerSavingRequested;
+        lock.unlock();
+        const ReopenResult result = reopenStream(isPowerSaving);
+        lock.lock();
+
+        if (result == ReopenResult::Failed) {
+            LOGE("The audio stream is down, it is opened again on the next mode change");
+            mIsReady = false;
+            mIsStreamLost = true;
+            break;
+        }
+
+        mOutputChannelCount = mAudioStream->getChannelCount();
+        if (mIsStreamLost) {
+            // Calls to `startPlaying` made while the stream was down were queued
+            mIsStreamLost = false;
+            mIsReady = true;
+            installBeatSounds(mIsSynthesizedClicks);
+            isStartPending = mIsStartPending;
+            mIsStartPending = false;
+        }
+
+        if (result == ReopenResult::Restored) {
+            // The requested mode cannot be opened right now, settle for the one that works
+            // rather than tearing it down again
+            mIsPowerSavingRequested = mIsStreamPowerSaving;
+            break;
+        }
+    }
+    mIsSwitchingMode = false;
+    lock.unlock();
+
+    if (isStartPending) {
+        startBeatThread();
+    }
+}
+
+bool Metronome::openInputStream() {
+    AudioStreamBuilder builder;
+    builder.setDirection(Direction::Input);
+    builder.setFormat(AudioFormat::Float);
+    builder.setFormatConversionAllowed(true);
+    builder.setPerformanceMode(PerformanceMode::LowLatency);
+    builder.setSharingMode(SharingMode::Exclusive);
+    builder.setInputPreset(InputPreset::Unprocessed);
+    builder.setSampleRate(kSampleRate);
+    builder.setSampleRateConversionQuality(SampleRateConversionQuality::Medium);
+    builder.setChannelCount(ChannelCount::Mono);
+    builder.setBufferCapacityInFrames(kMaxInputFrames);
+
+    Result result = builder.openStream(mInputStream);
+    if (result != Result::OK) {
+        LOGE("Failed to open input stream. Error: %s", convertToText(result));
         return false;
     }
 
-    if (!setupPlayerBeat(kAccentBeat, &mAccentBeatPlayer)) {
-        LOGE("Could not load source data for accent beat sound");
+    mInputBuffer = std::make_unique<float[]>(kMaxInputFrames);
+    return true;
+}
+
+bool Metronome::setTimingAnalysisEnabled(bool isEnabled) {
+    std::lock_guard<std::mutex> lock(mInitMutex);
+
+    if (!isEnabled) {
+        mAnalyzedInputStream.store(nullptr, std::memory_order_release);
+        if (mInputStream) {
+            mInputStream->requestStop();
+        }
+        return true;
+    }
+
+    if (!mInputStream && !openInputStream()) return false;
+
+    Result result = mInputStream->requestStart();
+    if (result != Result::OK) {
+        LOGE("Failed to start input stream. Error: %s", convertToText(result));
         return false;
     }
 
-    if (!setupPlayerBeat(kMediumBeat, &mMediumBeatPlayer)) {
-        LOGE("Could not load source data for medium beat sound");
+    mIsTimingAnalyzerResetPending.store(true, std::memory_order_relaxed);
+    mAnalyzedInputStream.store(mInputStream.get(), std::memory_order_release);
+    return true;
+}
+
+void Metronome::setLatencyCompensationMs(int32_t compensationMs) {
+    mLatencyCompensationFrames.store(static_cast<int64_t>(compensationMs) * kSampleRate / 1000,
+                                     std::memory_order_relaxed);
+}
+
+int32_t Metronome::drainTimingResults(TimingResult *results, int32_t maxResults) {
+    int32_t resultCount = 0;
+    while (resultCount < maxResults && mTimingAnalyzer.popResult(&results[resultCount])) {
+        ++resultCount;
+    }
+    return resultCount;
+}
+
+float Metronome::takeGainReductionDb() {
+    return mMixer.takeGainReductionDb();
+}
+
+void Metronome::setBusRoute(Bus bus, int32_t leftChannel, int32_t rightChannel, float gain) {
+    mMixer.setRoute(bus, leftChannel, rightChannel, gain);
+}
+
+int32_t Metronome::getOutputChannelCount() {
+    std::lock_guard<std::mutex> lock(mInitMutex);
+    return mIsReady ? mOutputChannelCount : 0;
+}
+
+void Metronome::realignToPhaseAnchor(AudioStream *stream) {
+
+    // Timestamps are not available for the first few callbacks of a stream
+    ResultWithValue<FrameTimestamp> timestamp = stream->getTimestamp(CLOCK_MONOTONIC);
+    if (!timestamp) return;
+    mIsPhaseAnchorPending.store(false, std::memory_order_relaxed);
+
+    // When the frame about to be rendered will be heard, and where the clock should be by then
+    const int64_t nextFrameNanos = timestamp.value().timestamp +
+            (stream->getFramesWritten() - timestamp.value().position) * kNanosPerSecond /
+            kSampleRate;
+    const int64_t framePosition = mPhaseAnchorFrame +
+            (nextFrameNanos - mPhaseAnchorNanos) * kSampleRate / kNanosPerSecond;
+
+    const int64_t correctionFrames = std::abs(framePosition - mSequencer.getFramePosition());
+    if (correctionFrames > 1 && correctionFrames < kMaxPhaseCorrectionFrames) {
+        mSequencer.seekTo(framePosition);
+    }
+}
+
+void Metronome::analyzeInput(AudioStream *outputStream, int64_t outputFrameOffset) {
+
+    AudioStream *inputStream = mAnalyzedInputStream.load(std::memory_order_acquire);
+    if (inputStream == nullptr) return;
+
+    if (mIsTimingAnalyzerResetPending.exchange(false, std::memory_order_relaxed)) {
+        // Whatever queued up while the analysis was off is stale
+        while (inputStream->read(mInputBuffer.get(), kMaxInputFrames, 0).value() > 0) {}
+        mTimingAnalyzer.reset();
+    }
+
+    // Both timestamps pair a frame with the time it was at the transducer, so mapping input frames
+    // through them onto the output clock cancels the latency of both paths
+    ResultWithValue<FrameTimestamp> outputTimestamp = outputStream->getTimestamp(CLOCK_MONOTONIC);
+    ResultWithValue<FrameTimestamp> inputTimestamp = inputStream->getTimestamp(CLOCK_MONOTONIC);
+    const bool hasTimestamps = outputTimestamp && inputTimestamp;
+    const int64_t compensationFrames = mLatencyCompensationFrames.load(std::memory_order_relaxed);
+
+    while (true) {
+        const int64_t firstInputFrame = inputStream->getFramesRead();
+        ResultWithValue<int32_t> framesRead = inputStream->read(mInputBuffer.get(),
+                                                                kMaxInputFrames, 0);
+        if (!framesRead || framesRead.value() == 0) break;
+
+        // Timestamps are not available for the first few callbacks of a stream
+        if (hasTimestamps) {
+            const int64_t captureNanos = inputTimestamp.value().timestamp +
+                    (firstInputFrame - inputTimestamp.value().position) * kNanosPerSecond /
+                    kSampleRate;
+            const int64_t presentedFrame = outputTimestamp.value().position +
+                    (captureNanos - outputTimestamp.value().timestamp) * kSampleRate /
+                    kNanosPerSecond;
+
+            mTimingAnalyzer.processInput(mInputBuffer.get(), framesRead.value(),
+                                         presentedFrame + outputFrameOffset - compensationFrames,
+                                         mSequencer.getFramePosition());
+        }
+
+        if (framesRead.value() < kMaxInputFrames) break;
+    }
+}
+
+const CallbackStats &Metronome::getCallbackStats(bool isPowerSaving) const {
+    return mCallbackStats[isPowerSaving ? 1 : 0];
+}
+
+bool Metronome::setupAudioSources(WorkerPool &pool) {
+
+    const char *beatNames[kStartupDecodeCount]{kNormalBeat, kAccentBeat, kMediumBeat};
+    std::unique_ptr<Player> *players[kStartupDecodeCount]{
+            &mNormalBeatPlayer, &mAccentBeatPlayer, &mMediumBeatPlayer
+    };
+
+    // Decodes are independent of each other and of the stream, so run them all concurrently
+    std::future<PhaseResult> decodes[kStartupDecodeCount];
+    for (int i = 0; i < kStartupDecodeCount; ++i) {
+        const char *beatName = beatNames[i];
+        std::unique_ptr<Player> *player = players[i];
+        decodes[i] = pool.submit([this, beatName, player]() {
+            return runPhase([this, beatName, player]() {
+                return setupPlayerBeat(beatName, player);
+            });
+        });
+    }
+
+    bool areAllLoaded = true;
+    for (int i = 0; i < kStartupDecodeCount; ++i) {
+        PhaseResult decodeResult = decodes[i].get();
+        {
+            std::lock_guard<std::mutex> lock(mInitMutex);
+            mStartupMetrics.decodeUs[i] = decodeResult.durationUs;
+        }
+        if (!decodeResult.isSuccessful) {
+            LOGE("Could not load source data for beat sound %s", beatNames[i]);
+            areAllLoaded = false;
+        }
+    }
+
+    if (!areAllLoaded) {
         return false;
     }
 
-    mMixer.addTrack(mNormalBeatPlayer.get());
-    mMixer.addTrack(mMediumBeatPlayer.get());
-    mMixer.addTrack(mAccentBeatPlayer.get());
-    mMixer.setChannelCount(mAudioStream->getChannelCount());
+    // The synthesized clicks cost nothing until triggered, so both sets are always mixed and
+    // switching between them only changes which one the Sequencer triggers
+    const AudioProperties properties{kChannelCount, kSampleRate};
+    mNormalClickSynth = std::make_unique<ClickSynth>(
+            clickParameters(ClickVoice::Woodblock, BeatState::Normal), properties);
+    mAccentClickSynth = std::make_unique<ClickSynth>(
+            clickParameters(ClickVoice::Woodblock, BeatState::Accent), properties);
+    mMediumClickSynth = std::make_unique<ClickSynth>(
+            clickParameters(ClickVoice::Woodblock, BeatState::Medium), properties);
+    // A voice of its own so the count-in stands apart from the song when both buses meet
+    mNormalCountInSynth = std::make_unique<ClickSynth>(
+            clickParameters(ClickVoice::Beep, BeatState::Normal), properties);
+    mAccentCountInSynth = std::make_unique<ClickSynth>(
+            clickParameters(ClickVoice::Beep, BeatState::Accent), properties);
+    mMediumCountInSynth = std::make_unique<ClickSynth>(
+            clickParameters(ClickVoice::Beep, BeatState::Medium), properties);
+
+    mMixer.removeAllTracks();
+    mMixer.addTrack(mNormalBeatPlayer.get(), Bus::Click);
+    mMixer.addTrack(mMediumBeatPlayer.get(), Bus::Click);
+    mMixer.addTrack(mAccentBeatPlayer.get(), Bus::Accent);
+    mMixer.addTrack(mNormalClickSynth.get(), Bus::Click);
+    mMixer.addTrack(mMediumClickSynth.get(), Bus::Click);
+    mMixer.addTrack(mAccentClickSynth.get(), Bus::Accent);
+    mMixer.addTrack(mNormalCountInSynth.get(), Bus::Cue);
+    mMixer.addTrack(mAccentCountInSynth.get(), Bus::Cue);
+    mMixer.addTrack(mMediumCountInSynth.get(), Bus::Cue);
     return true;
 }
 
+void Metronome::installBeatSounds(bool isSynthesized) {
+    mSequencer.setCountInPlayer(BeatState::Normal, mNormalCountInSynth.get());
+    mSequencer.setCountInPlayer(BeatState::Accent, mAccentCountInSynth.get());
+    mSequencer.setCountInPlayer(BeatState::Medium, mMediumCountInSynth.get());
+
+    if (isSynthesized) {
+        mSequencer.setPlayer(BeatState::Normal, mNormalClickSynth.get());
+        mSequencer.setPlayer(BeatState::Accent, mAccentClickSynth.get());
+        mSequencer.setPlayer(BeatState::Medium, mMediumClickSynth.get());
+    } else {
+        mSequencer.setPlayer(BeatState::Normal, mNormalBeatPlayer.get());
+        mSequencer.setPlayer(BeatState::Accent, mAccentBeatPlayer.get());
+        mSequencer.setPlayer(BeatState::Medium, mMediumBeatPlayer.get());
+    }
+}
+
+void Metronome::setSynthesizedClicks(bool isSynthesized) {
+    std::lock_guard<std::mutex> lock(mInitMutex);
+
+    // Installed by runInit once the sounds are set up
+    mIsSynthesizedClicks = isSynthesized;
+    if (mIsReady) {
+        installBeatSounds(isSynthesized);
+    }
+}
+
 bool Metronome::setupPlayerBeat(const char beat[], std::unique_ptr<Player> *playerBeat) {
 
     AudioProperties targetProperties{
@@ -87,13 +642,15 @@ bool Metronome::setupPlayerBeat(const char beat[], std::unique_ptr<Player> *play
             .sampleRate = kSampleRate
     };
 
-    std::shared_ptr<AAssetDataSource> mBeatSource{
-            AAssetDataSource::newFromCompressedAsset(mAssetManager,
-                                                     beat,
-                                                     targetProperties)
+    // Kept as 16-bit PCM, half the memory of floats for about the same render cost
+    std::shared_ptr<Pcm16DataSource> mBeatSource{
+            AAssetDataSource::newPcm16FromCompressedAsset(mAssetManager,
+                                                          beat,
+                                                          targetProperties)
     };
 
-    if (mBeatSource == nullptr) {
+    // A failed NDK decode still yields a source, just an empty one
+    if (mBeatSource == nullptr || mBeatSource->getSize() == 0) {
         return false;
     }
 
@@ -103,60 +660,95 @@ bool Metronome::setupPlayerBeat(const char beat[], std::unique_ptr<Player> *play
 }
 
 void Metronome::setBPM(int bpm) {
-    mBPM = bpm;
-    mIntervalMs = 60000 / mBPM;
+    mSequencer.setBPM(bpm);
 }
 
 void Metronome::setBeats(const std::vector<Beat> &beats) {
-    mBeats = beats;
+    mSequencer.setBeats(beats);
 }
 
-void Metronome::startPlaying() {
-    if (mIsMetronomePlaying) return;
-    if (mBeats.empty()) return;
+int32_t Metronome::loadProgram(const char *path) {
+    std::unique_ptr<Program> program = Program::fromFile(path);
+    if (!program) {
+        return -1;
+    }
 
-    mIsMetronomePlaying = true;
-    mCurrentBeatIndex = 0;
+    const int32_t songCount = program->getSongCount();
+    mPrograms.push_back(std::move(program));
+    return songCount;
+}
 
-    mBeatThread = std::thread([this]() {
-        std::unique_lock<std::mutex> lock(mMutex);
-        int totalBeatsPerMeasure = 0;
+bool Metronome::selectSong(int32_t songIndex) {
+    if (songIndex < 0) {
+        mSequencer.queueSong(nullptr);
+        return true;
+    }
 
-        while (mIsMetronomePlaying) {
+    if (mPrograms.empty()) return false;
 
-            totalBeatsPerMeasure = mBeats.size();
-            mCurrentBeatIndex = mCurrentBeatIndex % totalBeatsPerMeasure;
+    const Program &program = *mPrograms.back();
+    const SongTimeline *song = program.getSong(songIndex);
+    if (song == nullptr) {
+        LOGE("No song %d in the loaded program", songIndex);
+        return false;
+    }
 
-            lock.unlock();
-            notifyUiChangeBeat(mCurrentBeatIndex);
-            lock.lock();
+    LOGI("Queued song %s", program.getSongName(songIndex).c_str());
+    mSequencer.queueSong(song);
+    return true;
+}
 
-            const Beat &currentBeat = mBeats[mCurrentBeatIndex];
-            switch (currentBeat.stateDto) {
-                case BeatState::Normal:
-                    mNormalBeatPlayer->setPlaying(true);
-                    break;
+void Metronome::startPlaying() {
+    {
+        std::lock_guard<std::mutex> lock(mInitMutex);
+        if (!mIsReady) {
+            // Replayed by runInit once the stream has started
+            mIsStartPending = true;
+            return;
+        }
+    }
+
+    startBeatThread();
+}
+
+void Metronome::startBeatThread() {
+    if (mIsMetronomePlaying.exchange(true)) return;
+
+    mSequencer.start();
+
+    // The beats themselves are scheduled on the audio thread, this thread only forwards them to
+    // the UI. It sleeps until the next onset is due rather than polling at a fixed rate.
+    mBeatThread = std::thread([this]() {
+        std::unique_lock<std::mutex> lock(mMutex);
+        uint32_t lastBeatSerial = mSequencer.getBeatSerial();
 
-                case BeatState::Silence:
-                    break;
+        while (mIsMetronomePlaying) {
 
-                case BeatState::Accent:
-                    mAccentBeatPlayer->setPlaying(true);
-                    break;
+            const uint32_t beatSerial = mSequencer.getBeatSerial();
+            if (beatSerial != lastBeatSerial) {
+                lastBeatSerial = beatSerial;
+                const int beatIndex = mSequencer.getLastBeatIndex();
 
-                case BeatState::Medium:
-                    mMediumBeatPlayer->setPlaying(true);
-                    break;
+                lock.unlock();
+                notifyUiChangeBeat(beatIndex);
+                lock.lock();
             }
 
-            mCondition.wait_for(lock, std::chrono::milliseconds(mIntervalMs),
+            int64_t waitMs = mSequencer.getFramesUntilNextBeat() * 1000 / mSequencer.getSampleRate();
+            waitMs = std::max<int64_t>(kMinUiWaitMs, std::min<int64_t>(waitMs, kMaxUiWaitMs));
+
+            mCondition.wait_for(lock, std::chrono::milliseconds(waitMs),
                                 [this] { return !mIsMetronomePlaying; });
-            mCurrentBeatIndex = (mCurrentBeatIndex + 1) % totalBeatsPerMeasure;
         }
     });
 }
 
 void Metronome::stopPlaying() {
+    {
+        std::lock_guard<std::mutex> lock(mInitMutex);
+        mIsStartPending = false;
+    }
+    mSequencer.stop();
     {
         std::lock_guard<std::mutex> lock(mMutex);
         mIsMetronomePlaying = false;
@@ -3,12 +3,21 @@
 
 #include <vector>
 #include <thread>
+#include <functional>
 #include <android/asset_manager.h>
 #include <oboe/Oboe.h>
 
+#include "analysis/TimingAnalyzer.h"
 #include "model/Beat.h"
+#include "audio/ClickSynth.h"
 #include "audio/Player.h"
 #include "audio/Mixer.h"
+#include "audio/Sequencer.h"
+#include "program/Program.h"
+#include "utils/CallbackStats.h"
+#include "utils/Constants.h"
+#include "utils/StartupMetrics.h"
+#include "utils/WorkerPool.h"
 
 using namespace oboe;
 
@@ -22,44 +31,176 @@ void notifyUiChangeBeat(int beatIndex);
 
 class Metronome : public AudioStreamDataCallback {
 public:
-    explicit Metronome(AAssetManager &);
+    /**
+     * `deviceChannelCount` is the number of outputs of the device. The stream is opened with all
+     * of them so the buses can be routed to any output; 0 opens a stereo stream.
+     */
+    Metronome(AAssetManager &, int32_t deviceChannelCount);
 
     DataCallbackResult onAudioReady(
             AudioStream *oboeStream, void *audioData, int32_t numFrames) override;
 
-    void init();
+    /**
+     * Opens the audio stream and decodes the beat sounds on a small worker pool, off the calling
+     * thread. `onReady` is invoked from the init thread once the stream has been started (true) or
+     * setup has failed (false). Calls to `startPlaying` made before then are queued. The startup
+     * metrics are logged once the first callback has run.
+     */
+    void init(std::function<void(bool)> onReady);
     void end();
+    StartupMetrics getStartupMetrics();
     void setBPM(int bpm);
     void setBeats(const std::vector<Beat> &beats);
     void startPlaying();
     void stopPlaying();
 
+    /**
+     * Reopens the stream with `PerformanceMode::PowerSaving` and large callbacks, or back in low
+     * latency mode. Beat onsets stay sample exact in both modes and the beat phase carries over
+     * the switch. The stream is reopened on a background thread, so this returns right away;
+     * when called again before a switch has finished, the last requested mode wins. A mode that
+     * fails to open leaves the stream in the current one. If no stream opens at all the metronome
+     * stops being ready (`getOutputChannelCount` returns 0) until a later call reopens it.
+     */
+    void setPowerSavingMode(bool isPowerSaving);
+    const CallbackStats &getCallbackStats(bool isPowerSaving) const;
+
+    /**
+     * Maps a compiled program (setlist) file and returns its song count, or -1 if it could not be
+     * loaded. Loaded programs stay mapped until the metronome is destroyed so songs can be
+     * switched without copying.
+     */
+    int32_t loadProgram(const char *path);
+
+    /**
+     * Plays clicks synthesized in the callback instead of the bundled beat sounds, or goes back
+     * to those. Takes effect from the next beat, a sound already playing rings out.
+     */
+    void setSynthesizedClicks(bool isSynthesized);
+
+    /**
+     * Switches to song `songIndex` of the last loaded program at the next bar line. A negative
+     * index goes back to the pattern set with `setBeats`.
+     */
+    bool selectSong(int32_t songIndex);
+
+    /**
+     * Opens the microphone alongside the output and measures how far each played note lands from
+     * the beat grid. The input is read without blocking from the output callback and mapped onto
+     * the output clock through the stream timestamps, which compensates the round-trip latency;
+     * `setLatencyCompensationMs` covers what the timestamps cannot see (transducers, air).
+     * Requires the RECORD_AUDIO permission.
+     */
+    bool setTimingAnalysisEnabled(bool isEnabled);
+    void setLatencyCompensationMs(int32_t compensationMs);
+
+    /**
+     * Moves up to `maxResults` pending measurements to `results` and returns how many there were.
+     */
+    int32_t drainTimingResults(TimingResult *results, int32_t maxResults);
+
+    /**
+     * Largest gain reduction applied by the output limiter since the previous call, in dB.
+     */
+    float takeGainReductionDb();
+
+    /**
+     * Routes the two sides of `bus` to the output channels `leftChannel` and `rightChannel`, a
+     * negative channel drops that side. Takes effect from the next callback and is kept when the
+     * stream is reopened; channels the device does not have are left silent.
+     */
+    void setBusRoute(Bus bus, int32_t leftChannel, int32_t rightChannel, float gain);
+
+    /**
+     * Channel count the output stream was opened with, 0 until it is ready.
+     */
+    int32_t getOutputChannelCount();
+
 private:
     Mixer mMixer;
+    Sequencer mSequencer{mMixer, kSampleRate};
     std::shared_ptr<AudioStream> mAudioStream;
     std::unique_ptr<Player> mNormalBeatPlayer;
     std::unique_ptr<Player> mAccentBeatPlayer;
     std::unique_ptr<Player> mMediumBeatPlayer;
+    std::unique_ptr<ClickSynth> mNormalClickSynth;
+    std::unique_ptr<ClickSynth> mAccentClickSynth;
+    std::unique_ptr<ClickSynth> mMediumClickSynth;
+    // Count-in bars of a song, mixed to the cue bus
+    std::unique_ptr<ClickSynth> mNormalCountInSynth;
+    std::unique_ptr<ClickSynth> mAccentCountInSynth;
+    std::unique_ptr<ClickSynth> mMediumCountInSynth;
+
+    std::vector<std::unique_ptr<Program>> mPrograms;
+
+    TimingAnalyzer mTimingAnalyzer{kSampleRate};
+    std::shared_ptr<AudioStream> mInputStream;
+    std::unique_ptr<float[]> mInputBuffer;
+    // The input stream the callback reads, null while the analysis is off
+    std::atomic<AudioStream *> mAnalyzedInputStream{nullptr};
+    std::atomic<bool> mIsTimingAnalyzerResetPending{false};
+    std::atomic<int64_t> mLatencyCompensationFrames{0};
 
+    std::thread mInitThread;
+    std::thread mModeSwitchThread;
     std::thread mBeatThread;
     std::atomic<bool> mIsMetronomePlaying{false};
 
     std::mutex mMutex;
     std::condition_variable mCondition;
 
-    std::vector<Beat> mBeats;
-    int mBPM{60};
-    int mIntervalMs{1000};
-    int mCurrentBeatIndex{0};
+    std::mutex mInitMutex;
+    std::condition_variable mInitCondition;
+    bool mIsReady{false};
+    bool mIsEnding{false};
+    bool mIsStartPending{false};
+    bool mIsPowerSavingRequested{false};
+    bool mIsStreamPowerSaving{false};
+    bool mIsSynthesizedClicks{false};
+    bool mIsSwitchingMode{false};
+    // A switch failed to bring up any stream, mIsReady is cleared until one opens again
+    bool mIsStreamLost{false};
+    int32_t mOutputChannelCount{0};
+
+    CallbackStats mCallbackStats[2];
+    std::atomic<CallbackStats *> mActiveCallbackStats{&mCallbackStats[0]};
+
+    // Sequencer frame that was heard at mPhaseAnchorNanos (CLOCK_MONOTONIC) before the last
+    // reopen, for the audio thread to line the new stream up with once it has timestamps
+    int64_t mPhaseAnchorFrame{0};
+    int64_t mPhaseAnchorNanos{0};
+    std::atomic<bool> mIsPhaseAnchorPending{false};
+
+    std::chrono::steady_clock::time_point mInitStartTime;
+    StartupMetrics mStartupMetrics;
+    std::atomic<int64_t> mFirstCallbackUs{-1};
 
-    bool openStream();
-    bool setupAudioSources();
+    void runInit(const std::function<void(bool)> &onReady);
+    void logStartupMetrics();
+    bool openStream(bool isPowerSaving);
+    enum class ReopenResult {
+        Switched,
+        // The requested mode failed to open, the stream is back in the previous one
+        Restored,
+        // No stream could be opened or started
+        Failed
+    };
+    ReopenResult reopenStream(bool isPowerSaving);
+    void startModeSwitch();
+    void runModeSwitch();
+    bool openInputStream();
+    void realignToPhaseAnchor(AudioStream *stream);
+    void analyzeInput(AudioStream *outputStream, int64_t outputFrameOffset);
+    bool setupAudioSources(WorkerPool &pool);
     bool setupPlayerBeat(const char beat[], std::unique_ptr<Player> *playerBeat);
+    void installBeatSounds(bool isSynthesized);
+    void startBeatThread();
 
 #pragma clang diagnostic push
 #pragma clang diagnostic ignored "-Wunused-private-field"
     AAssetManager &mAssetManager;
 #pragma clang diagnostic pop
+    const int32_t mDeviceChannelCount;
 };
 
 #endif //METRONOMEPLUS_METRONOME_H
\ No newline at end of file
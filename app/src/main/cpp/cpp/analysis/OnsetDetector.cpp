@@ -0,0 +1,100 @@
+#include <algorithm>
+#include <cstring>
+
+#include "OnsetDetector.h"
+#include "../utils/Simd.h"
+
+namespace {
+
+// A hop must be this much louder than the background (about 12 dB) to count as an onset
+constexpr float kOnsetEnergyRatio { 16.0f };
+// and above this absolute level (-60 dBFS) so room noise is never picked up
+constexpr float kMinOnsetEnergy { 1e-6f };
+// The onset is placed on the first sample within 13 dB of the hop's peak
+constexpr float kPeakEnergyFraction { 0.05f };
+constexpr int32_t kRefractoryMs { 60 };
+constexpr int32_t kBackgroundTimeConstantMs { 100 };
+
+}
+
+OnsetDetector::OnsetDetector(int32_t sampleRate)
+    : mRefractoryFrames(sampleRate * kRefractoryMs / 1000)
+    , mBackgroundRate(static_cast<float>(kOnsetHopFrames) * 1000 /
+                      (static_cast<float>(sampleRate) * kBackgroundTimeConstantMs))
+{
+}
+
+void OnsetDetector::reset() {
+    std::memset(mHistory, 0, sizeof(mHistory));
+    mHopFill = 0;
+    mFramesProcessed = 0;
+    mLastOnsetFrame = 0;
+    mBackgroundEnergy = 0;
+    mHasOnset = false;
+}
+
+int32_t OnsetDetector::process(const float *input, int32_t numFrames, int64_t *onsets,
+                               int32_t maxOnsets) {
+    int32_t onsetCount = 0;
+    int32_t framesRead = 0;
+
+    while (framesRead < numFrames) {
+        const int32_t framesToCopy = std::min(numFrames - framesRead, kOnsetHopFrames - mHopFill);
+        std::memcpy(&mHistory[kOnsetHopFrames + mHopFill], &input[framesRead],
+                    framesToCopy * sizeof(float));
+        mHopFill += framesToCopy;
+        framesRead += framesToCopy;
+
+        if (mHopFill < kOnsetHopFrames) break;
+
+        const int64_t hopStartFrame = mFramesProcessed + framesRead - kOnsetHopFrames;
+        int64_t onset;
+        if (analyzeHop(hopStartFrame, &onset) && onsetCount < maxOnsets) {
+            onsets[onsetCount++] = onset;
+        }
+
+        std::memcpy(mHistory, &mHistory[kOnsetHopFrames], kOnsetHopFrames * sizeof(float));
+        mHopFill = 0;
+    }
+
+    mFramesProcessed += numFrames;
+    return onsetCount;
+}
+
+bool OnsetDetector::analyzeHop(int64_t hopStartFrame, int64_t *onset) {
+
+    const float *hop = &mHistory[kOnsetHopFrames];
+    const float energy = sumOfSquares(hop, kOnsetHopFrames) / kOnsetHopFrames;
+
+    const bool isRefractory = mHasOnset && hopStartFrame - mLastOnsetFrame < mRefractoryFrames;
+    const bool isOnset = !isRefractory && energy >= kMinOnsetEnergy &&
+                         energy >= mBackgroundEnergy * kOnsetEnergyRatio;
+
+    if (!isOnset) {
+        // The background follows everything but the attacks, so a sustained note is absorbed
+        // before the refractory period ends instead of triggering again
+        mBackgroundEnergy += (energy - mBackgroundEnergy) * mBackgroundRate;
+        return false;
+    }
+
+    // Search from the previous hop, since the attack may have started before the hop boundary
+    float peakEnergy = 0;
+    for (int32_t i = 0; i < 2 * kOnsetHopFrames; ++i) {
+        peakEnergy = std::max(peakEnergy, mHistory[i] * mHistory[i]);
+    }
+    const float threshold = std::max(peakEnergy * kPeakEnergyFraction,
+                                     mBackgroundEnergy * kOnsetEnergyRatio);
+
+    int32_t attack = 0;
+    while (attack < 2 * kOnsetHopFrames && mHistory[attack] * mHistory[attack] < threshold) {
+        ++attack;
+    }
+    if (attack == 2 * kOnsetHopFrames) {
+        return false;
+    }
+
+    *onset = hopStartFrame - kOnsetHopFrames + attack;
+    mLastOnsetFrame = *onset;
+    mHasOnset = true;
+    return true;
+}
@@ -0,0 +1,46 @@
+#ifndef METRONOMEPLUS_ONSETDETECTOR_H
+#define METRONOMEPLUS_ONSETDETECTOR_H
+
+#include <cstdint>
+
+constexpr int32_t kOnsetHopFrames { 64 };
+
+/**
+ * Real-time onset detector on the energy envelope of a mono signal. The input is cut into hops of
+ * `kOnsetHopFrames`; a hop whose energy jumps well above the slowly tracked background level marks
+ * an onset, which is then refined to the first loud sample of that hop or the one before it.
+ *
+ * The per-sample work is a single vectorized sum of squares, so it is cheap enough to run inside
+ * the audio callback on low-end devices. No allocation happens after construction.
+ */
+class OnsetDetector {
+
+public:
+    explicit OnsetDetector(int32_t sampleRate);
+
+    /**
+     * Feeds `numFrames` samples and writes the frames of the onsets found, counted from the first
+     * frame fed since the last `reset`, to `onsets`. Returns how many were written, at most
+     * `maxOnsets`.
+     */
+    int32_t process(const float *input, int32_t numFrames, int64_t *onsets, int32_t maxOnsets);
+    void reset();
+
+    int64_t getFramesProcessed() const { return mFramesProcessed; };
+
+private:
+    const int32_t mRefractoryFrames;
+    const float mBackgroundRate;
+
+    // The previous hop followed by the one being filled
+    float mHistory[2 * kOnsetHopFrames]{};
+    int32_t mHopFill = 0;
+    int64_t mFramesProcessed = 0;
+    int64_t mLastOnsetFrame = 0;
+    float mBackgroundEnergy = 0;
+    bool mHasOnset = false;
+
+    bool analyzeHop(int64_t hopStartFrame, int64_t *onset);
+};
+
+#endif //METRONOMEPLUS_ONSETDETECTOR_H
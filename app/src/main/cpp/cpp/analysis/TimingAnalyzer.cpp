@@ -0,0 +1,76 @@
+#include <algorithm>
+#include <cstdlib>
+
+#include "TimingAnalyzer.h"
+
+namespace {
+
+// Notes further than this from any beat are not meant to be on the grid and are ignored
+constexpr int32_t kDefaultMaxDeviationMs { 150 };
+
+}
+
+TimingAnalyzer::TimingAnalyzer(int32_t sampleRate)
+    : mSampleRate(sampleRate)
+    , mMaxDeviationFrames(static_cast<int64_t>(kDefaultMaxDeviationMs) * sampleRate / 1000)
+    , mDetector(sampleRate)
+{
+}
+
+void TimingAnalyzer::onBeat(int64_t beatFrame) {
+    mBeatFrames[mNextBeatSlot] = beatFrame;
+    mNextBeatSlot = (mNextBeatSlot + 1) % kBeatHistorySize;
+    mBeatCount = std::min(mBeatCount + 1, kBeatHistorySize);
+}
+
+void TimingAnalyzer::processInput(const float *input, int32_t numFrames,
+                                  int64_t firstOutputFrame, int64_t renderedFrame) {
+
+    // The detector counts frames from its own start, shift them onto the Sequencer clock
+    const int64_t outputFrameOffset = firstOutputFrame - mDetector.getFramesProcessed();
+    const int32_t onsetCount = mDetector.process(input, numFrames, mOnsets, kMaxOnsetsPerBlock);
+
+    // When notes come in faster than they can be matched the newest are dropped
+    const int32_t acceptedCount = std::min(onsetCount, kMaxPendingOnsets - mPendingOnsetCount);
+    for (int32_t i = 0; i < acceptedCount; ++i) {
+        mPendingOnsets[mPendingOnsetCount++] = mOnsets[i] + outputFrameOffset;
+    }
+
+    // Every beat an onset could belong to is known once the output is past it by the deviation
+    const int64_t maxDeviationFrames = mMaxDeviationFrames.load(std::memory_order_relaxed);
+    int32_t matchedCount = 0;
+    while (matchedCount < mPendingOnsetCount &&
+           mPendingOnsets[matchedCount] + maxDeviationFrames < renderedFrame) {
+        matchOnset(mPendingOnsets[matchedCount], maxDeviationFrames);
+        ++matchedCount;
+    }
+    std::copy(&mPendingOnsets[matchedCount], &mPendingOnsets[mPendingOnsetCount],
+              &mPendingOnsets[0]);
+    mPendingOnsetCount -= matchedCount;
+}
+
+void TimingAnalyzer::reset() {
+    mDetector.reset();
+    mBeatCount = 0;
+    mNextBeatSlot = 0;
+    mPendingOnsetCount = 0;
+}
+
+void TimingAnalyzer::matchOnset(int64_t onsetFrame, int64_t maxDeviationFrames) {
+    int32_t nearestSlot = -1;
+    int64_t nearestDistance = maxDeviationFrames + 1;
+
+    for (int32_t i = 0; i < mBeatCount; ++i) {
+        const int64_t distance = std::llabs(onsetFrame - mBeatFrames[i]);
+        if (distance < nearestDistance) {
+            nearestDistance = distance;
+            nearestSlot = i;
+        }
+    }
+    if (nearestSlot < 0) return;
+
+    const int64_t beatFrame = mBeatFrames[nearestSlot];
+    const float deviationMs = static_cast<float>(onsetFrame - beatFrame) * 1000 / mSampleRate;
+    // When the UI falls behind the oldest results are kept, newer ones are dropped
+    mResults.push(TimingResult{beatFrame, deviationMs});
+}
@@ -0,0 +1,83 @@
+#ifndef METRONOMEPLUS_TIMINGANALYZER_H
+#define METRONOMEPLUS_TIMINGANALYZER_H
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+#include "OnsetDetector.h"
+#include "../audio/BeatListener.h"
+#include "../utils/SpscRing.h"
+
+constexpr int32_t kBeatHistorySize { 16 };
+constexpr int32_t kMaxOnsetsPerBlock { 32 };
+constexpr int32_t kMaxPendingOnsets { 32 };
+constexpr uint32_t kTimingResultCapacity { 256 };
+
+struct TimingResult {
+    // Sequencer frame of the beat the note was matched to
+    int64_t beatFrame;
+    // Positive when the note came after the beat
+    float deviationMs;
+};
+
+/**
+ * Measures how far each played note lands from the beat grid. Beats arrive from the Sequencer and
+ * microphone input from the same audio callback; onsets found in the input are matched to the
+ * nearest scheduled beat and the deviation is queued for the UI in a lock-free ring.
+ *
+ * Beats are only known once they have been rendered, so each onset is held back until the
+ * Sequencer has rendered past it by the maximum deviation. A note played ahead of a beat that had
+ * not been rendered yet when the note came in is still matched to that beat.
+ *
+ * The caller maps input frames onto the Sequencer clock, which is where the round-trip latency of
+ * the output and input paths is compensated.
+ */
+class TimingAnalyzer : public BeatListener {
+
+public:
+    explicit TimingAnalyzer(int32_t sampleRate);
+
+    // Audio thread
+    void onBeat(int64_t beatFrame) override;
+
+    /**
+     * Analyzes a block of mono input whose first frame was captured at `firstOutputFrame` on the
+     * Sequencer clock. `renderedFrame` is the Sequencer frame the output has been rendered up to,
+     * every beat before it has been announced through `onBeat`. Audio thread only.
+     */
+    void processInput(const float *input, int32_t numFrames, int64_t firstOutputFrame,
+                      int64_t renderedFrame);
+
+    /**
+     * Drops the beat history, pending onsets and detector state, e.g. after the input has been interrupted. Must
+     * not be called concurrently with the audio thread.
+     */
+    void reset();
+
+    // UI thread
+    bool popResult(TimingResult *result) { return mResults.pop(result); };
+    void setMaxDeviationMs(int32_t maxDeviationMs) {
+        mMaxDeviationFrames.store(static_cast<int64_t>(maxDeviationMs) * mSampleRate / 1000,
+                                  std::memory_order_relaxed);
+    };
+
+private:
+    const int32_t mSampleRate;
+    std::atomic<int64_t> mMaxDeviationFrames;
+    SpscRing<TimingResult, kTimingResultCapacity> mResults;
+
+    // Audio thread state
+    OnsetDetector mDetector;
+    std::array<int64_t, kBeatHistorySize> mBeatFrames{};
+    int32_t mBeatCount = 0;
+    int32_t mNextBeatSlot = 0;
+    int64_t mOnsets[kMaxOnsetsPerBlock]{};
+    // Onsets on the Sequencer clock waiting for the beats around them to be rendered, oldest first
+    int64_t mPendingOnsets[kMaxPendingOnsets]{};
+    int32_t mPendingOnsetCount = 0;
+
+    void matchOnset(int64_t onsetFrame, int64_t maxDeviationFrames);
+};
+
+#endif //METRONOMEPLUS_TIMINGANALYZER_H
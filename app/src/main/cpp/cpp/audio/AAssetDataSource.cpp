@@ -1,49 +1,84 @@
+#include <cstring>
+
 #include "../utils/Logging.h"
-#include <oboe/Oboe.h>
 
 #include "AAssetDataSource.h"
 
 #include "NDKExtractor.h"
+#include "SampleConversion.h"
 
 
 constexpr int kMaxCompressionRatio { 12 };
 
-AAssetDataSource* AAssetDataSource::newFromCompressedAsset(
-        AAssetManager &assetManager,
-        const char *filename,
-        const AudioProperties targetProperties) {
+namespace {
 
+AAsset *openAsset(AAssetManager &assetManager, const char *filename) {
     AAsset *asset = AAssetManager_open(&assetManager, filename, AASSET_MODE_UNKNOWN);
     if (!asset) {
         LOGE("Failed to open asset %s", filename);
         return nullptr;
     }
+    LOGD("Opened %s, size %ld", filename, AAsset_getLength(asset));
+    return asset;
+}
 
-    off_t assetSize = AAsset_getLength(asset);
-    LOGD("Opened %s, size %ld", filename, assetSize);
+/**
+ * Decodes a compressed asset with the NDK media codecs, which always produce 16-bit PCM. Returns
+ * the number of samples written to `outputBuffer`.
+ */
+int64_t decodeWithExtractor(AAsset *asset, const AudioProperties targetProperties,
+                            std::unique_ptr<int16_t[]> &outputBuffer) {
 
     // Allocate memory to store the decompressed audio. We don't know the exact
     // size of the decoded data until after decoding so we make an assumption about the
     // maximum compression ratio and the decoded sample format (float for FFmpeg, int16 for NDK).
-    const long maximumDataSizeInBytes = kMaxCompressionRatio * assetSize * sizeof(int16_t);
-    auto decodedData = new uint8_t[maximumDataSizeInBytes];
+    const long maximumDataSizeInBytes =
+            kMaxCompressionRatio * AAsset_getLength(asset) * sizeof(int16_t);
+    auto decodedData = std::make_unique<uint8_t[]>(maximumDataSizeInBytes);
 
-    int64_t bytesDecoded = NDKExtractor::decode(asset, decodedData, targetProperties);
+    int64_t bytesDecoded = NDKExtractor::decode(asset, decodedData.get(), targetProperties);
     auto numSamples = bytesDecoded / sizeof(int16_t);
 
-    // Now we know the exact number of samples we can create a float array to hold the audio data
-    auto outputBuffer = std::make_unique<float[]>(numSamples);
+    // Now we know the exact number of samples we can trim the buffer to size
+    outputBuffer = std::make_unique<int16_t[]>(numSamples);
+    memcpy(outputBuffer.get(), decodedData.get(), numSamples * sizeof(int16_t));
+    return numSamples;
+}
 
-    // The NDK decoder can only decode to int16, we need to convert to floats
-    oboe::convertPcm16ToFloat(
-            reinterpret_cast<int16_t*>(decodedData),
-            outputBuffer.get(),
-            bytesDecoded / sizeof(int16_t));
+}
+
+AAssetDataSource* AAssetDataSource::newFromCompressedAsset(
+        AAssetManager &assetManager,
+        const char *filename,
+        const AudioProperties targetProperties) {
 
-    delete[] decodedData;
+    AAsset *asset = openAsset(assetManager, filename);
+    if (!asset) return nullptr;
+
+    std::unique_ptr<int16_t[]> decodedData;
+    int64_t numSamples = decodeWithExtractor(asset, targetProperties, decodedData);
     AAsset_close(asset);
 
+    // The NDK decoder can only decode to int16, we need to convert to floats
+    auto outputBuffer = std::make_unique<float[]>(numSamples);
+    convertPcm16ToFloat(decodedData.get(), outputBuffer.get(), numSamples);
+
     return new AAssetDataSource(std::move(outputBuffer),
             numSamples,
             targetProperties);
-}
\ No newline at end of file
+}
+
+Pcm16DataSource* AAssetDataSource::newPcm16FromCompressedAsset(
+        AAssetManager &assetManager,
+        const char *filename,
+        const AudioProperties targetProperties) {
+
+    AAsset *asset = openAsset(assetManager, filename);
+    if (!asset) return nullptr;
+
+    std::unique_ptr<int16_t[]> samples;
+    int64_t numSamples = decodeWithExtractor(asset, targetProperties, samples);
+    AAsset_close(asset);
+
+    return new Pcm16DataSource(std::move(samples), numSamples, targetProperties);
+}
@@ -2,9 +2,11 @@
 #define METRONOMEPLUS_AASSETDATASOURCE_H
 
 #include <experimental/__config>
+#include <memory>
 #include <android/asset_manager.h>
 #include "../utils/Constants.h"
 #include "DataSource.h"
+#include "Pcm16DataSource.h"
 
 class AAssetDataSource : public DataSource {
 
@@ -18,6 +20,14 @@ public:
             const char *filename,
             AudioProperties targetProperties);
 
+    /**
+     * Decodes the asset like `newFromCompressedAsset` but keeps the samples as 16-bit PCM.
+     */
+    static Pcm16DataSource* newPcm16FromCompressedAsset(
+            AAssetManager &assetManager,
+            const char *filename,
+            AudioProperties targetProperties);
+
 private:
 
     AAssetDataSource(std::unique_ptr<float[]> data, size_t size,
@@ -0,0 +1,18 @@
+#ifndef METRONOMEPLUS_BEATLISTENER_H
+#define METRONOMEPLUS_BEATLISTENER_H
+
+#include <cstdint>
+
+class BeatListener {
+
+public:
+    virtual ~BeatListener() = default;
+
+    /**
+     * Called on the audio thread for every beat of the grid, audible or not, with the frame (in
+     * Sequencer frames) its onset is scheduled on.
+     */
+    virtual void onBeat(int64_t beatFrame) = 0;
+};
+
+#endif //METRONOMEPLUS_BEATLISTENER_H
@@ -0,0 +1,177 @@
+#include <algorithm>
+#include <type_traits>
+
+#include "BusRouter.h"
+#include "../utils/Simd.h"
+
+namespace {
+
+/**
+ * Stereo bus to stereo output, two frames per vector: each output sample takes its own side of
+ * the bus through `sameSideGains` and the other side through `otherSideGains`.
+ */
+void applyStereo(const float *busData, float *output, int32_t numFrames,
+                 const float *leftGains, const float *rightGains) {
+    const float sameSide[4]{leftGains[0], rightGains[1], leftGains[0], rightGains[1]};
+    const float otherSide[4]{rightGains[0], leftGains[1], rightGains[0], leftGains[1]};
+    const float4 sameSideGains = load4(sameSide);
+    const float4 otherSideGains = load4(otherSide);
+
+    const int32_t numSamples = numFrames * 2;
+    int32_t i = 0;
+    for (; i + 4 <= numSamples; i += 4) {
+        const float4 frames = load4(&busData[i]);
+        const float4 mixed = add4(mul4(frames, sameSideGains),
+                                  mul4(swapPairs4(frames), otherSideGains));
+        store4(&output[i], add4(load4(&output[i]), mixed));
+    }
+
+    for (; i < numSamples; i += 2) {
+        output[i] += leftGains[0] * busData[i] + rightGains[0] * busData[i + 1];
+        output[i + 1] += leftGains[1] * busData[i] + rightGains[1] * busData[i + 1];
+    }
+}
+
+/**
+ * Any other layout, one frame at a time: both sides of the bus are mixed into the `ChannelSpan`
+ * channels the bus reaches, four at a time. The span is a template argument so the per frame
+ * loops unroll instead of being set up again on every frame.
+ */
+template<int32_t ChannelSpan>
+void applySpan(const float *busData, float *output, int32_t numFrames,
+               int32_t outputChannelCount, const float *leftGains, const float *rightGains) {
+    constexpr int32_t vectorChannels = ChannelSpan / 4 * 4;
+    float4 leftVectorGains[vectorChannels / 4 + 1];
+    float4 rightVectorGains[vectorChannels / 4 + 1];
+    for (int32_t channel = 0; channel < vectorChannels; channel += 4) {
+        leftVectorGains[channel / 4] = load4(&leftGains[channel]);
+        rightVectorGains[channel / 4] = load4(&rightGains[channel]);
+    }
+
+    for (int32_t frame = 0; frame < numFrames; ++frame) {
+        const float left = busData[frame * kBusChannelCount];
+        const float right = busData[frame * kBusChannelCount + 1];
+        float *outputFrame = &output[frame * outputChannelCount];
+
+        for (int32_t channel = 0; channel < vectorChannels; channel += 4) {
+            const float4 mixed = add4(mul4(splat4(left), leftVectorGains[channel / 4]),
+                                      mul4(splat4(right), rightVectorGains[channel / 4]));
+            store4(&outputFrame[channel], add4(load4(&outputFrame[channel]), mixed));
+        }
+        for (int32_t channel = vectorChannels; channel < ChannelSpan; ++channel) {
+            outputFrame[channel] += left * leftGains[channel] + right * rightGains[channel];
+        }
+    }
+}
+
+constexpr int32_t kMaxUnrolledSpan = 8;
+
+void applyInterleaved(const float *busData, float *output, int32_t numFrames,
+                      int32_t outputChannelCount, int32_t channelSpan,
+                      const float *leftGains, const float *rightGains) {
+    // Wider spans are mixed in several passes over the bus, one run of channels at a time
+    for (int32_t channel = 0; channel < channelSpan; channel += kMaxUnrolledSpan) {
+        const int32_t span = std::min(channelSpan - channel, kMaxUnrolledSpan);
+        const auto apply = [&](auto spanConstant) {
+            applySpan<decltype(spanConstant)::value>(busData, &output[channel], numFrames,
+                                                     outputChannelCount, &leftGains[channel],
+                                                     &rightGains[channel]);
+        };
+        switch (span) {
+            case 1: apply(std::integral_constant<int32_t, 1>()); break;
+            case 2: apply(std::integral_constant<int32_t, 2>()); break;
+            case 3: apply(std::integral_constant<int32_t, 3>()); break;
+            case 4: apply(std::integral_constant<int32_t, 4>()); break;
+            case 5: apply(std::integral_constant<int32_t, 5>()); break;
+            case 6: apply(std::integral_constant<int32_t, 6>()); break;
+            case 7: apply(std::integral_constant<int32_t, 7>()); break;
+            default: apply(std::integral_constant<int32_t, kMaxUnrolledSpan>()); break;
+        }
+    }
+}
+
+int8_t toStoredChannel(int32_t channel) {
+    return channel >= 0 && channel < kMaxOutputChannels ? static_cast<int8_t>(channel)
+                                                         : static_cast<int8_t>(kUnrouted);
+}
+
+}
+
+BusRouter::BusRouter() {
+    for (int32_t i = 0; i < kBusCount; ++i) {
+        mLeftChannels[i].store(0, std::memory_order_relaxed);
+        mRightChannels[i].store(1, std::memory_order_relaxed);
+        mGains[i].store(1, std::memory_order_relaxed);
+    }
+    rebuild();
+}
+
+void BusRouter::setRoute(Bus bus, int32_t leftChannel, int32_t rightChannel, float gain) {
+    const auto index = static_cast<int32_t>(bus);
+    mLeftChannels[index].store(toStoredChannel(leftChannel), std::memory_order_relaxed);
+    mRightChannels[index].store(toStoredChannel(rightChannel), std::memory_order_relaxed);
+    mGains[index].store(std::max(gain, 0.0f), std::memory_order_relaxed);
+    mRouteSerial.fetch_add(1, std::memory_order_release);
+}
+
+void BusRouter::setOutputChannelCount(int32_t channelCount) {
+    mOutputChannelCount = channelCount;
+    rebuild();
+}
+
+void BusRouter::update() {
+    if (mRouteSerial.load(std::memory_order_acquire) != mAppliedRouteSerial) {
+        rebuild();
+    }
+}
+
+void BusRouter::apply(Bus bus, const float *busData, float *output, int32_t numFrames) const {
+    const BusMix &mix = mMixes[static_cast<int32_t>(bus)];
+    if (mix.channelSpan == 0) return;
+
+    if (mOutputChannelCount == 2 && mix.channelSpan == 2) {
+        applyStereo(busData, output, numFrames, mix.leftGains, mix.rightGains);
+    } else {
+        applyInterleaved(busData, &output[mix.firstChannel], numFrames, mOutputChannelCount,
+                         mix.channelSpan, mix.leftGains, mix.rightGains);
+    }
+}
+
+void BusRouter::rebuild() {
+    mAppliedRouteSerial = mRouteSerial.load(std::memory_order_acquire);
+    const int32_t routableChannels = std::min(mOutputChannelCount, kMaxOutputChannels);
+
+    for (int32_t i = 0; i < kBusCount; ++i) {
+        BusMix &mix = mMixes[i];
+        std::fill(std::begin(mix.leftGains), std::end(mix.leftGains), 0.0f);
+        std::fill(std::begin(mix.rightGains), std::end(mix.rightGains), 0.0f);
+        mix.firstChannel = 0;
+        mix.channelSpan = 0;
+
+        int32_t leftChannel = mLeftChannels[i].load(std::memory_order_relaxed);
+        int32_t rightChannel = mRightChannels[i].load(std::memory_order_relaxed);
+        const float gain = mGains[i].load(std::memory_order_relaxed);
+
+        // A mono device gets everything that is routed at all
+        if (mOutputChannelCount == 1) {
+            leftChannel = std::min(leftChannel, 0);
+            rightChannel = std::min(rightChannel, 0);
+        }
+        if (leftChannel >= routableChannels) leftChannel = kUnrouted;
+        if (rightChannel >= routableChannels) rightChannel = kUnrouted;
+
+        const bool hasLeft = leftChannel != kUnrouted;
+        const bool hasRight = rightChannel != kUnrouted;
+        if (gain == 0 || (!hasLeft && !hasRight)) continue;
+
+        const float sideGain = leftChannel == rightChannel ? gain / 2 : gain;
+        const int32_t firstChannel = std::min(hasLeft ? leftChannel : rightChannel,
+                                              hasRight ? rightChannel : leftChannel);
+        const int32_t lastChannel = std::max(leftChannel, rightChannel);
+
+        mix.firstChannel = firstChannel;
+        mix.channelSpan = lastChannel - firstChannel + 1;
+        if (hasLeft) mix.leftGains[leftChannel - firstChannel] = sideGain;
+        if (hasRight) mix.rightGains[rightChannel - firstChannel] = sideGain;
+    }
+}
@@ -0,0 +1,84 @@
+#ifndef METRONOMEPLUS_BUSROUTER_H
+#define METRONOMEPLUS_BUSROUTER_H
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include "../utils/Constants.h"
+
+/**
+ * Named submixes the Mixer's tracks render to. Each is routed to the outputs on its own, so the
+ * click can go to an in-ear mix while a cue voice goes to the front of house, for instance.
+ */
+enum class Bus : uint8_t {
+    Click,
+    Accent,
+    // Count-in bars of a song
+    Cue
+};
+
+constexpr int32_t kBusCount = 3;
+// Every track renders at the channel count the beat sounds are decoded to
+constexpr int32_t kBusChannelCount = kChannelCount;
+// Highest output channel a bus can be routed to, plenty for USB interfaces
+constexpr int32_t kMaxOutputChannels = 32;
+// A bus channel routed here is dropped
+constexpr int32_t kUnrouted = -1;
+
+/**
+ * The routing matrix between the buses and the output channels. Each side of a bus goes to one
+ * output channel (or none) and the whole bus is scaled by its own gain. Both sides of a bus on
+ * the same output are averaged into it, which is also how everything is folded down on a mono
+ * device. Routes to channels the stream does not have are dropped.
+ *
+ * Routes can be changed from any thread and take effect at the start of the next callback.
+ * Every bus starts on the first two outputs at unity gain.
+ */
+class BusRouter {
+
+public:
+    BusRouter();
+
+    void setRoute(Bus bus, int32_t leftChannel, int32_t rightChannel, float gain);
+
+    /**
+     * Sets the interleaved layout of the output. Must not be called while rendering.
+     */
+    void setOutputChannelCount(int32_t channelCount);
+    int32_t getOutputChannelCount() const { return mOutputChannelCount; }
+
+    /**
+     * Picks up route changes made since the previous call. Audio thread only.
+     */
+    void update();
+
+    bool isRouted(Bus bus) const { return mMixes[static_cast<int32_t>(bus)].channelSpan > 0; }
+
+    /**
+     * Adds `numFrames` of `busData`, interleaved at `kBusChannelCount`, to `output`, interleaved
+     * at the output channel count. Audio thread only.
+     */
+    void apply(Bus bus, const float *busData, float *output, int32_t numFrames) const;
+
+private:
+    // Gains from each side of a bus to the run of output channels it reaches
+    struct BusMix {
+        int32_t firstChannel;
+        int32_t channelSpan;
+        float leftGains[kMaxOutputChannels];
+        float rightGains[kMaxOutputChannels];
+    };
+
+    std::array<std::atomic<int8_t>, kBusCount> mLeftChannels;
+    std::array<std::atomic<int8_t>, kBusCount> mRightChannels;
+    std::array<std::atomic<float>, kBusCount> mGains;
+    std::atomic<uint32_t> mRouteSerial{0};
+
+    uint32_t mAppliedRouteSerial = 0;
+    int32_t mOutputChannelCount = 1;
+    std::array<BusMix, kBusCount> mMixes;
+
+    void rebuild();
+};
+
+#endif //METRONOMEPLUS_BUSROUTER_H
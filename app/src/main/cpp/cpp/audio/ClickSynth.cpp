@@ -0,0 +1,182 @@
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include "ClickSynth.h"
+#include "MemoryDataSource.h"
+#include "../utils/Simd.h"
+
+namespace {
+
+constexpr float kTwoPi = 6.283185307f;
+// ln(10^4), the number of time constants for an envelope to fall by 80 dB
+constexpr float kDecayTimeConstants = 9.21034f;
+constexpr float kNoiseScale = 1.0f / 2147483648.0f;
+// Added to the envelopes so they settle far below audibility instead of decaying into denormals,
+// which are very slow to multiply on some CPUs
+constexpr float kDenormalGuard = 1e-18f;
+
+// Indexed by BeatState: Normal, Silence, Accent, Medium
+const ClickParameters kClickPresets[][kBeatStateCount] = {
+        // Woodblock
+        {{1200, 25, 2, 0.25f, 0.5f}, {1200, 25, 2, 0.25f, 0},
+         {1800, 35, 3, 0.25f, 0.8f}, {1500, 30, 2, 0.25f, 0.65f}},
+        // Beep
+        {{880, 40, 1, 0, 0.4f}, {880, 40, 1, 0, 0},
+         {1760, 50, 1, 0, 0.6f}, {1320, 45, 1, 0, 0.5f}},
+        // Rim
+        {{500, 10, 6, 0.6f, 0.5f}, {500, 10, 6, 0.6f, 0},
+         {700, 12, 8, 0.7f, 0.8f}, {600, 11, 7, 0.65f, 0.65f}},
+};
+
+int64_t clickLengthFrames(const ClickParameters &parameters, int32_t sampleRate) {
+    const float decayMs = std::max(parameters.toneDecayMs, parameters.noiseDecayMs);
+    return static_cast<int64_t>(std::ceil(decayMs * kDecayTimeConstants * sampleRate / 1000));
+}
+
+}
+
+ClickParameters clickParameters(ClickVoice voice, BeatState state) {
+    return kClickPresets[static_cast<int>(voice)][state];
+}
+
+ClickSynth::ClickSynth(const ClickParameters &parameters, AudioProperties properties)
+    : mParameters(parameters)
+    , mProperties(properties)
+    , mLengthFrames(clickLengthFrames(parameters, properties.sampleRate))
+{
+    const float sampleRate = static_cast<float>(properties.sampleRate);
+    const float phaseStep = kTwoPi * parameters.frequencyHz / sampleRate;
+
+    // Lane k holds frame k of every group of four, so all lanes advance by four frames per step
+    mRotationCos = std::cos(4 * phaseStep);
+    mRotationSin = std::sin(4 * phaseStep);
+    mToneDecayStep = std::exp(-4000 / (parameters.toneDecayMs * sampleRate));
+    mNoiseDecayStep = std::exp(-4000 / (parameters.noiseDecayMs * sampleRate));
+
+    for (int lane = 0; lane < 4; ++lane) {
+        mInitialPhasorCos[lane] = std::cos(lane * phaseStep);
+        mInitialPhasorSin[lane] = std::sin(lane * phaseStep);
+        mInitialToneEnvelope[lane] =
+                std::exp(-1000 * lane / (parameters.toneDecayMs * sampleRate));
+        mInitialNoiseEnvelope[lane] =
+                std::exp(-1000 * lane / (parameters.noiseDecayMs * sampleRate));
+    }
+}
+
+void ClickSynth::setPlaying(bool isPlaying) {
+    if (!isPlaying) {
+        mIsPlaying = false;
+        return;
+    }
+
+    std::memcpy(mPhasorCos, mInitialPhasorCos, sizeof(mPhasorCos));
+    std::memcpy(mPhasorSin, mInitialPhasorSin, sizeof(mPhasorSin));
+    std::memcpy(mToneEnvelope, mInitialToneEnvelope, sizeof(mToneEnvelope));
+    std::memcpy(mNoiseEnvelope, mInitialNoiseEnvelope, sizeof(mNoiseEnvelope));
+    // Any nonzero seed works for xorshift, distinct ones keep the lanes uncorrelated
+    for (uint32_t lane = 0; lane < 4; ++lane) {
+        mNoiseState[lane] = 0x9E3779B9u * (lane + 1);
+    }
+
+    mFramePosition = 0;
+    mBlockReadIndex = kSynthBlockFrames;
+    mIsPlaying = true;
+}
+
+void ClickSynth::renderAudio(float *targetData, int32_t numFrames) {
+
+    const int32_t channelCount = mProperties.channelCount;
+    int32_t framesRendered = 0;
+
+    if (mIsPlaying) {
+        const int32_t framesToRender = static_cast<int32_t>(
+                std::min<int64_t>(numFrames, mLengthFrames - mFramePosition));
+
+        while (framesRendered < framesToRender) {
+            if (mBlockReadIndex == kSynthBlockFrames) {
+                synthesizeBlock();
+            }
+
+            const int32_t framesToCopy = std::min(framesToRender - framesRendered,
+                                                  kSynthBlockFrames - mBlockReadIndex);
+            const float *block = &mBlock[mBlockReadIndex];
+            float *target = &targetData[framesRendered * channelCount];
+            if (channelCount == 2) {
+                // Stereo gets its own loop so the compiler can vectorize the interleave
+                for (int32_t i = 0; i < framesToCopy; ++i) {
+                    target[2 * i] = block[i];
+                    target[2 * i + 1] = block[i];
+                }
+            } else {
+                for (int32_t i = 0; i < framesToCopy; ++i) {
+                    for (int32_t j = 0; j < channelCount; ++j) {
+                        target[i * channelCount + j] = block[i];
+                    }
+                }
+            }
+
+            mBlockReadIndex += framesToCopy;
+            framesRendered += framesToCopy;
+        }
+
+        mFramePosition += framesRendered;
+        if (mFramePosition >= mLengthFrames) {
+            mIsPlaying = false;
+        }
+    }
+
+    std::memset(&targetData[framesRendered * channelCount], 0,
+                sizeof(float) * (numFrames - framesRendered) * channelCount);
+}
+
+void ClickSynth::synthesizeBlock() {
+
+    const float4 rotationCos = splat4(mRotationCos);
+    const float4 rotationSin = splat4(mRotationSin);
+    const float4 toneDecayStep = splat4(mToneDecayStep);
+    const float4 noiseDecayStep = splat4(mNoiseDecayStep);
+    const float4 toneGain = splat4(mParameters.gain * (1 - mParameters.noiseLevel));
+    const float4 noiseGain = splat4(mParameters.gain * mParameters.noiseLevel * kNoiseScale);
+    const float4 denormalGuard = splat4(kDenormalGuard);
+
+    float4 phasorCos = load4(mPhasorCos);
+    float4 phasorSin = load4(mPhasorSin);
+    float4 toneEnvelope = load4(mToneEnvelope);
+    float4 noiseEnvelope = load4(mNoiseEnvelope);
+    uint4 noise = loadu4(mNoiseState);
+
+    for (int32_t i = 0; i < kSynthBlockFrames; i += 4) {
+        noise = xor4(noise, shiftLeft4<13>(noise));
+        noise = xor4(noise, shiftRight4<17>(noise));
+        noise = xor4(noise, shiftLeft4<5>(noise));
+
+        const float4 tone = mul4(mul4(phasorSin, toneEnvelope), toneGain);
+        const float4 burst = mul4(mul4(toFloat4(noise), noiseEnvelope), noiseGain);
+        store4(&mBlock[i], add4(tone, burst));
+
+        const float4 nextCos = sub4(mul4(phasorCos, rotationCos), mul4(phasorSin, rotationSin));
+        phasorSin = add4(mul4(phasorCos, rotationSin), mul4(phasorSin, rotationCos));
+        phasorCos = nextCos;
+        toneEnvelope = add4(mul4(toneEnvelope, toneDecayStep), denormalGuard);
+        noiseEnvelope = add4(mul4(noiseEnvelope, noiseDecayStep), denormalGuard);
+    }
+
+    store4(mPhasorCos, phasorCos);
+    store4(mPhasorSin, phasorSin);
+    store4(mToneEnvelope, toneEnvelope);
+    store4(mNoiseEnvelope, noiseEnvelope);
+    storeu4(mNoiseState, noise);
+    mBlockReadIndex = 0;
+}
+
+std::shared_ptr<DataSource> ClickSynth::bake() const {
+    const int64_t numSamples = mLengthFrames * mProperties.channelCount;
+    auto data = std::make_unique<float[]>(static_cast<size_t>(numSamples));
+
+    ClickSynth synth(mParameters, mProperties);
+    synth.setPlaying(true);
+    synth.renderAudio(data.get(), static_cast<int32_t>(mLengthFrames));
+
+    return std::make_shared<MemoryDataSource>(std::move(data), numSamples, mProperties);
+}
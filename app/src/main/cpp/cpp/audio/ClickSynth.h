@@ -0,0 +1,94 @@
+#ifndef METRONOMEPLUS_CLICKSYNTH_H
+#define METRONOMEPLUS_CLICKSYNTH_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+#include "DataSource.h"
+#include "IPlayableAudio.h"
+#include "../model/Beat.h"
+#include "../utils/Constants.h"
+
+constexpr int32_t kSynthBlockFrames { 64 };
+
+enum class ClickVoice : int8_t {
+    Woodblock,
+    Beep,
+    Rim
+};
+
+struct ClickParameters {
+    float frequencyHz;
+    // Time constants of the exponential envelopes
+    float toneDecayMs;
+    float noiseDecayMs;
+    // Share of the noise burst in the mix, the tone gets the rest
+    float noiseLevel;
+    float gain;
+};
+
+/**
+ * Preset for `voice` at the accent level of `state`. Stronger beats are higher and ring longer;
+ * Silence has zero gain.
+ */
+ClickParameters clickParameters(ClickVoice voice, BeatState state);
+
+/**
+ * Synthesizes a click in the callback instead of playing back a decoded asset: a sine oscillator
+ * plus a noise burst, each shaped by an exponential envelope. There is nothing to load and the
+ * whole state is a few vector registers; samples are generated four lanes at a time into a small
+ * block buffer and copied to every output channel.
+ *
+ * `bake` renders the click once into a DataSource for use with a Player, the cheapest playback
+ * path when memory is not a concern.
+ */
+class ClickSynth : public IPlayableAudio {
+
+public:
+    ClickSynth(const ClickParameters &parameters, AudioProperties properties);
+
+    void renderAudio(float *targetData, int32_t numFrames) override;
+    void setPlaying(bool isPlaying) override;
+    bool isPlaying() const { return mIsPlaying; };
+
+    /**
+     * Length of the click in frames, until both envelopes have fallen by 80 dB.
+     */
+    int64_t getLengthFrames() const { return mLengthFrames; };
+
+    std::shared_ptr<DataSource> bake() const;
+
+private:
+    const ClickParameters mParameters;
+    const AudioProperties mProperties;
+    const int64_t mLengthFrames;
+
+    // Per lane increments, applied once per group of four frames
+    float mRotationCos;
+    float mRotationSin;
+    float mToneDecayStep;
+    float mNoiseDecayStep;
+
+    // Lane state at the start of the click, so triggering it is just a copy
+    float mInitialPhasorCos[4]{};
+    float mInitialPhasorSin[4]{};
+    float mInitialToneEnvelope[4]{};
+    float mInitialNoiseEnvelope[4]{};
+
+    std::atomic<bool> mIsPlaying { false };
+    int64_t mFramePosition = 0;
+    int32_t mBlockReadIndex = kSynthBlockFrames;
+    float mBlock[kSynthBlockFrames]{};
+
+    // Lane state: oscillator phasor, envelopes and noise generators
+    float mPhasorCos[4]{};
+    float mPhasorSin[4]{};
+    float mToneEnvelope[4]{};
+    float mNoiseEnvelope[4]{};
+    uint32_t mNoiseState[4]{};
+
+    void synthesizeBlock();
+};
+
+#endif //METRONOMEPLUS_CLICKSYNTH_H
@@ -4,12 +4,23 @@
 #include <cstdint>
 #include "../utils/Constants.h"
 
+enum class SampleFormat : int8_t {
+    Float,
+    // Signed 16-bit PCM, converted to float while rendering at half the memory
+    Pcm16
+};
+
 class DataSource {
 public:
     virtual ~DataSource(){};
+    // Number of samples, across all channels
     virtual int64_t getSize() const = 0;
     virtual AudioProperties getProperties() const  = 0;
+    virtual SampleFormat getSampleFormat() const { return SampleFormat::Float; }
+
+    // Only the accessor matching `getSampleFormat` returns data, the other returns nullptr
     virtual const float* getData() const = 0;
+    virtual const int16_t* getPcm16Data() const { return nullptr; }
 };
 
 #endif //METRONOMEPLUS_AUDIOSOURCE_H
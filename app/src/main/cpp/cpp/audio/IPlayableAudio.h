@@ -0,0 +1,18 @@
+#ifndef METRONOMEPLUS_IPLAYABLEAUDIO_H
+#define METRONOMEPLUS_IPLAYABLEAUDIO_H
+
+#include "IRenderableAudio.h"
+
+/**
+ * A sound that can be triggered, such as a sample Player or a synthesized click.
+ */
+class IPlayableAudio : public IRenderableAudio {
+
+public:
+    /**
+     * Starts the sound from its beginning, or silences it. Called on the audio thread.
+     */
+    virtual void setPlaying(bool isPlaying) = 0;
+};
+
+#endif //METRONOMEPLUS_IPLAYABLEAUDIO_H
@@ -0,0 +1,109 @@
+#include <algorithm>
+#include <cmath>
+
+#include "Limiter.h"
+#include "../utils/Simd.h"
+
+namespace {
+
+constexpr float kLimiterReleaseMs { 100 };
+// Once this close to unity the gain is considered released and the bypass can kick in again
+constexpr float kReleasedGain { 0.9999f };
+constexpr float kKneeRange { kLimiterCeiling - kLimiterKnee };
+
+/**
+ * Scales `numSamples` by a gain ramping linearly from `startGain` to `endGain`, then applies the
+ * soft knee. The ramp advances per sample rather than per frame, a difference far too small to
+ * hear, so the kernel does not depend on the channel count.
+ */
+void applyGainAndSaturate(float *data, int32_t numSamples, float startGain, float endGain) {
+    const float gainStep = (endGain - startGain) / numSamples;
+
+    const float4 knee = splat4(kLimiterKnee);
+    const float4 kneeRange = splat4(kKneeRange);
+    const float4 inverseKneeRange = splat4(1 / kKneeRange);
+    const float4 zero = splat4(0);
+    const float4 one = splat4(1);
+    const float4 rampStep = splat4(4 * gainStep);
+    const float laneOffsets[4]{0, 1, 2, 3};
+    float4 gain = add4(splat4(startGain), mul4(splat4(gainStep), load4(laneOffsets)));
+
+    int32_t i = 0;
+    for (; i + 4 <= numSamples; i += 4) {
+        const float4 sample = mul4(load4(&data[i]), gain);
+        const float4 magnitude = abs4(sample);
+
+        // Above the knee the overshoot u is mapped to u / (1 + u), which has unit slope at the
+        // knee and approaches the ceiling asymptotically
+        const float4 overshoot = mul4(max4(sub4(magnitude, knee), zero), inverseKneeRange);
+        const float4 bent = mul4(kneeRange, div4(overshoot, add4(one, overshoot)));
+        const float4 limited = add4(min4(magnitude, knee), bent);
+
+        store4(&data[i], copySign4(limited, sample));
+        gain = add4(gain, rampStep);
+    }
+
+    for (; i < numSamples; ++i) {
+        data[i] = limiterSaturate(data[i] * (startGain + gainStep * i));
+    }
+}
+
+}
+
+float limiterSaturate(float sample) {
+    const float magnitude = std::abs(sample);
+    const float overshoot = std::max(magnitude - kLimiterKnee, 0.0f) / kKneeRange;
+    const float limited = std::min(magnitude, kLimiterKnee) +
+                          kKneeRange * overshoot / (1 + overshoot);
+    return std::copysign(limited, sample);
+}
+
+Limiter::Limiter(int32_t sampleRate)
+    : mReleaseFrames(kLimiterReleaseMs * sampleRate / 1000)
+    , mChunkReleaseRate(1 - std::exp(-kLimiterChunkFrames / mReleaseFrames))
+{
+}
+
+void Limiter::process(float *audioData, int32_t numFrames) {
+
+    const float blockPeak = peakAbs(audioData, numFrames * mChannelCount);
+    if (blockPeak <= kLimiterKnee && mGain == 1) return;
+
+    // Smallest ratio of output to input level over the chunks, for the meter
+    float lowestPeakRatio = 1;
+
+    for (int32_t frame = 0; frame < numFrames; frame += kLimiterChunkFrames) {
+        const int32_t chunkFrames = std::min(kLimiterChunkFrames, numFrames - frame);
+        const int32_t chunkSamples = chunkFrames * mChannelCount;
+        float *chunk = &audioData[frame * mChannelCount];
+
+        // Enough reduction to bring the chunk's peak down to the ceiling, released slowly
+        const float peak = peakAbs(chunk, chunkSamples);
+        const float targetGain = peak > kLimiterCeiling ? kLimiterCeiling / peak : 1.0f;
+        float nextGain = targetGain;
+        if (targetGain >= mGain) {
+            const float releaseRate = chunkFrames == kLimiterChunkFrames
+                                      ? mChunkReleaseRate
+                                      : 1 - std::exp(-chunkFrames / mReleaseFrames);
+            nextGain = mGain + (targetGain - mGain) * releaseRate;
+        }
+
+        if (peak > kLimiterKnee) {
+            lowestPeakRatio = std::min(lowestPeakRatio, limiterSaturate(peak * nextGain) / peak);
+        }
+
+        applyGainAndSaturate(chunk, chunkSamples, mGain, nextGain);
+        mGain = nextGain >= kReleasedGain ? 1.0f : nextGain;
+    }
+
+    if (lowestPeakRatio < 1) {
+        reportGainReduction(-20 * std::log10(lowestPeakRatio));
+    }
+}
+
+void Limiter::reportGainReduction(float reductionDb) {
+    float current = mGainReductionDb.load(std::memory_order_relaxed);
+    while (reductionDb > current &&
+           !mGainReductionDb.compare_exchange_weak(current, reductionDb,
+                                                   std::memory_order_relaxed)) {}
+}
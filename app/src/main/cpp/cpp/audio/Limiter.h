@@ -0,0 +1,63 @@
+#ifndef METRONOMEPLUS_LIMITER_H
+#define METRONOMEPLUS_LIMITER_H
+
+#include <atomic>
+#include <cstdint>
+
+// Samples below the knee pass through untouched, nothing ever leaves the ceiling
+constexpr float kLimiterKnee { 0.7f };
+constexpr float kLimiterCeiling { 1.0f };
+constexpr int32_t kLimiterChunkFrames { 32 };
+
+/**
+ * Output safety stage for the mix bus, so overlapping sounds never clip hard at the DAC.
+ *
+ * There is no lookahead and so no added latency. The gain is computed per chunk of
+ * `kLimiterChunkFrames` from the chunk's peak: reductions take effect within the chunk, ramped
+ * from the previous gain, and release with a 100 ms time constant. A chunk cut short by the end of
+ * a block releases by its share of that, so the release time does not depend on the channel count
+ * or on how the callbacks split the output. A soft knee saturator then
+ * rounds off whatever the ramp lets through, so the output stays below the ceiling without a
+ * hard corner. Both stages are branch-free vector kernels, and a block whose peak is below the
+ * knee while the gain is fully released is returned untouched.
+ */
+class Limiter {
+
+public:
+    explicit Limiter(int32_t sampleRate);
+
+    /**
+     * Sets the interleaved layout of the audio to process. Must not be called while processing.
+     */
+    void setChannelCount(int32_t channelCount) { mChannelCount = channelCount; };
+
+    /**
+     * Limits `numFrames` interleaved frames in place. All channels share the same gain, which
+     * keeps the stereo image. Audio thread only.
+     */
+    void process(float *audioData, int32_t numFrames);
+
+    /**
+     * Largest gain reduction, in dB, since the previous call. Safe to call from the UI thread.
+     */
+    float takeGainReductionDb() {
+        return mGainReductionDb.exchange(0, std::memory_order_relaxed);
+    };
+
+private:
+    // Release time constant in frames, and the share of the way to the target a whole chunk covers
+    const float mReleaseFrames;
+    const float mChunkReleaseRate;
+    int32_t mChannelCount = 1;
+    float mGain = 1;
+    std::atomic<float> mGainReductionDb{0};
+
+    void reportGainReduction(float reductionDb);
+};
+
+/**
+ * The soft knee: identity up to `kLimiterKnee`, then bending smoothly towards `kLimiterCeiling`.
+ */
+float limiterSaturate(float sample);
+
+#endif //METRONOMEPLUS_LIMITER_H
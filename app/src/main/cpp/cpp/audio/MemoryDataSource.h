@@ -0,0 +1,31 @@
+#ifndef METRONOMEPLUS_MEMORYDATASOURCE_H
+#define METRONOMEPLUS_MEMORYDATASOURCE_H
+
+#include <memory>
+#include "../utils/Constants.h"
+#include "DataSource.h"
+
+/**
+ * Sample data generated in memory, e.g. a baked ClickSynth.
+ */
+class MemoryDataSource : public DataSource {
+
+public:
+    MemoryDataSource(std::unique_ptr<float[]> data, int64_t size,
+                     const AudioProperties properties)
+            : mBuffer(std::move(data))
+            , mBufferSize(size)
+            , mProperties(properties) {
+    }
+
+    int64_t getSize() const override { return mBufferSize; }
+    AudioProperties getProperties() const override { return mProperties; }
+    const float* getData() const override { return mBuffer.get(); }
+
+private:
+    const std::unique_ptr<float[]> mBuffer;
+    const int64_t mBufferSize;
+    const AudioProperties mProperties;
+};
+
+#endif //METRONOMEPLUS_MEMORYDATASOURCE_H
@@ -1,40 +1,75 @@
 #ifndef METRONOMEPLUS_MIXER_H
 #define METRONOMEPLUS_MIXER_H
 
+#include <algorithm>
 #include <array>
+#include <cstring>
+#include "BusRouter.h"
 #include "IRenderableAudio.h"
+#include "Limiter.h"
+#include "../utils/Constants.h"
 
 constexpr int32_t kBufferSize = 192*10;  // Temporary buffer is used for mixing
 constexpr uint8_t kMaxTracks = 100;
 
 /**
- * A Mixer object which sums the output from multiple tracks into a single output. The number of
- * input channels on each track must match the number of output channels (default 1=mono). This can
- * be changed by calling `setChannelCount`.
+ * A Mixer object which sums the output from multiple tracks into a single output. Each track
+ * renders `kBusChannelCount` channels into one of the buses, and the buses are then mixed into
+ * the output's channels (default 1=mono, changed by calling `setChannelCount`) through a
+ * BusRouter, see `setRoute`.
  * The inputs to the mixer are not owned by the mixer, they should not be deleted while rendering.
+ * The sum goes through a Limiter so overlapping sounds never clip.
  */
 class Mixer : public IRenderableAudio {
 
 public:
     void renderAudio(float *audioData, int32_t numFrames) {
 
+        mRouter.update();
+
         // Zero out the incoming container array
         memset(audioData, 0, sizeof(float) * numFrames * mChannelCount);
 
-        for (int i = 0; i < mNextFreeTrackIndex; ++i) {
-            mTracks[i]->renderAudio(mixingBuffer, numFrames);
+        // Large callbacks (e.g. in power saving mode) are mixed in chunks of the mixing buffer
+        constexpr int32_t maxFramesPerChunk = kBufferSize / kBusChannelCount;
 
-            for (int j = 0; j < numFrames * mChannelCount; ++j) {
-                audioData[j] += mixingBuffer[j];
+        for (int32_t offset = 0; offset < numFrames; offset += maxFramesPerChunk) {
+            const int32_t framesToMix = std::min(maxFramesPerChunk, numFrames - offset);
+            float *output = &audioData[offset * mChannelCount];
+
+            for (int32_t bus = 0; bus < kBusCount; ++bus) {
+                if (renderBus(static_cast<Bus>(bus), framesToMix) &&
+                    mRouter.isRouted(static_cast<Bus>(bus))) {
+                    mRouter.apply(static_cast<Bus>(bus), busBuffer, output, framesToMix);
+                }
             }
         }
+
+        mLimiter.process(audioData, numFrames);
     }
 
-    void addTrack(IRenderableAudio *renderer){
+    void addTrack(IRenderableAudio *renderer, Bus bus = Bus::Click){
+        mTrackBuses[mNextFreeTrackIndex] = bus;
         mTracks[mNextFreeTrackIndex++] = renderer;
     }
 
-    void setChannelCount(int32_t channelCount){ mChannelCount = channelCount; }
+    void setChannelCount(int32_t channelCount){
+        mChannelCount = channelCount;
+        mRouter.setOutputChannelCount(channelCount);
+        mLimiter.setChannelCount(channelCount);
+    }
+    int32_t getChannelCount() const { return mChannelCount; }
+
+    /**
+     * Sends the two sides of `bus` to the output channels `leftChannel` and `rightChannel`
+     * (`kUnrouted` for none) at `gain`. Safe to call while rendering.
+     */
+    void setRoute(Bus bus, int32_t leftChannel, int32_t rightChannel, float gain) {
+        mRouter.setRoute(bus, leftChannel, rightChannel, gain);
+    }
+
+    // Largest limiter gain reduction in dB since the previous call, for metering on the UI thread
+    float takeGainReductionDb() { return mLimiter.takeGainReductionDb(); }
 
     void removeAllTracks(){
         for (int i = 0; i < mNextFreeTrackIndex; i++){
@@ -45,9 +80,43 @@ public:
 
 private:
     float mixingBuffer[kBufferSize];
+    float busBuffer[kBufferSize];
     std::array<IRenderableAudio*, kMaxTracks> mTracks;
+    std::array<Bus, kMaxTracks> mTrackBuses;
     uint8_t mNextFreeTrackIndex = 0;
     int32_t mChannelCount = 1; // Default to mono
+    BusRouter mRouter;
+    Limiter mLimiter{kSampleRate};
+
+    // Sums the tracks on `bus` into the bus buffer, returns false if it has no tracks. Tracks on a
+    // bus that is muted or routed nowhere are still rendered, only not summed, so their sounds
+    // move on in time instead of resuming where they were when the bus comes back.
+    bool renderBus(Bus bus, int32_t numFrames) {
+        const bool isRouted = mRouter.isRouted(bus);
+
+        bool hasTracks = false;
+        for (int i = 0; i < mNextFreeTrackIndex; ++i) {
+            if (mTrackBuses[i] != bus) continue;
+
+            if (!isRouted) {
+                mTracks[i]->renderAudio(mixingBuffer, numFrames);
+                continue;
+            }
+
+            // The first track renders straight into the bus, the others are added to it
+            if (!hasTracks) {
+                mTracks[i]->renderAudio(busBuffer, numFrames);
+                hasTracks = true;
+                continue;
+            }
+
+            mTracks[i]->renderAudio(mixingBuffer, numFrames);
+            for (int j = 0; j < numFrames * kBusChannelCount; ++j) {
+                busBuffer[j] += mixingBuffer[j];
+            }
+        }
+        return hasTracks;
+    }
 };
 
 #endif //METRONOMEPLUS_MIXER_H
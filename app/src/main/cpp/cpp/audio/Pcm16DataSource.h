@@ -0,0 +1,34 @@
+#ifndef METRONOMEPLUS_PCM16DATASOURCE_H
+#define METRONOMEPLUS_PCM16DATASOURCE_H
+
+#include <memory>
+#include "../utils/Constants.h"
+#include "DataSource.h"
+
+/**
+ * Keeps the samples as 16-bit PCM, half the memory of a float source and twice as many samples per
+ * cache line. The Player converts them while rendering.
+ */
+class Pcm16DataSource : public DataSource {
+
+public:
+    Pcm16DataSource(std::unique_ptr<int16_t[]> data, int64_t size,
+                    const AudioProperties properties)
+            : mBuffer(std::move(data))
+            , mBufferSize(size)
+            , mProperties(properties) {
+    }
+
+    int64_t getSize() const override { return mBufferSize; }
+    AudioProperties getProperties() const override { return mProperties; }
+    SampleFormat getSampleFormat() const override { return SampleFormat::Pcm16; }
+    const float* getData() const override { return nullptr; }
+    const int16_t* getPcm16Data() const override { return mBuffer.get(); }
+
+private:
+    const std::unique_ptr<int16_t[]> mBuffer;
+    const int64_t mBufferSize;
+    const AudioProperties mProperties;
+};
+
+#endif //METRONOMEPLUS_PCM16DATASOURCE_H
@@ -1,16 +1,20 @@
+#include <algorithm>
+#include <cstring>
+
 #include "Player.h"
+#include "SampleConversion.h"
 #include "../utils/Logging.h"
 #include "../utils/Constants.h"
 
 void Player::renderAudio(float *targetData, int32_t numFrames){
 
     const AudioProperties properties = mSource->getProperties();
+    const int64_t totalSourceFrames = mSource->getSize() / properties.channelCount;
+    int64_t framesRendered = 0;
 
-    if (mIsPlaying){
+    if (mIsPlaying && totalSourceFrames > 0){
 
         int64_t framesToRenderFromData = numFrames;
-        int64_t totalSourceFrames = mSource->getSize() / properties.channelCount;
-        const float *data = mSource->getData();
 
         // Check whether we're about to reach the end of the recording
         if (!mIsLooping && mReadFrameIndex + numFrames >= totalSourceFrames){
@@ -18,27 +22,36 @@ void Player::renderAudio(float *targetData, int32_t numFrames){
             mIsPlaying = false;
         }
 
-        for (int i = 0; i < framesToRenderFromData; ++i) {
-            for (int j = 0; j < properties.channelCount; ++j) {
-                targetData[(i*properties.channelCount)+j] = data[(mReadFrameIndex*properties.channelCount)+j];
-            }
+        // Copy contiguous runs of the source, splitting only where it wraps around
+        while (framesRendered < framesToRenderFromData) {
+            const int64_t framesToCopy = std::min(framesToRenderFromData - framesRendered,
+                                                  totalSourceFrames - mReadFrameIndex);
 
-            // Increment and handle wraparound
-            if (++mReadFrameIndex >= totalSourceFrames) mReadFrameIndex = 0;
-        }
+            renderFrames(&targetData[framesRendered * properties.channelCount],
+                         mReadFrameIndex * properties.channelCount,
+                         framesToCopy * properties.channelCount);
 
-        if (framesToRenderFromData < numFrames){
-            // fill the rest of the buffer with silence
-            renderSilence(&targetData[framesToRenderFromData], numFrames * properties.channelCount);
+            framesRendered += framesToCopy;
+            mReadFrameIndex += static_cast<int32_t>(framesToCopy);
+            if (mReadFrameIndex >= totalSourceFrames) mReadFrameIndex = 0;
         }
+    }
+
+    if (framesRendered < numFrames){
+        // fill the rest of the buffer with silence
+        renderSilence(&targetData[framesRendered * properties.channelCount],
+                      static_cast<int32_t>((numFrames - framesRendered) * properties.channelCount));
+    }
+}
 
+void Player::renderFrames(float *targetData, int64_t sourceOffset, int64_t numSamples){
+    if (mSource->getSampleFormat() == SampleFormat::Pcm16) {
+        convertPcm16ToFloat(&mSource->getPcm16Data()[sourceOffset], targetData, numSamples);
     } else {
-        renderSilence(targetData, numFrames * properties.channelCount);
+        memcpy(targetData, &mSource->getData()[sourceOffset], sizeof(float) * numSamples);
     }
 }
 
 void Player::renderSilence(float *start, int32_t numSamples){
-    for (int i = 0; i < numSamples; ++i) {
-        start[i] = 0;
-    }
-}
\ No newline at end of file
+    memset(start, 0, sizeof(float) * numSamples);
+}
@@ -8,12 +8,10 @@
 #include <memory>
 #include <atomic>
 
-#include <android/asset_manager.h>
-
 #include "DataSource.h"
-#include "IRenderableAudio.h"
+#include "IPlayableAudio.h"
 
-class Player : public IRenderableAudio{
+class Player : public IPlayableAudio {
 
 public:
     /**
@@ -27,9 +25,9 @@ public:
         : mSource(source)
     {};
 
-    void renderAudio(float *targetData, int32_t numFrames);
+    void renderAudio(float *targetData, int32_t numFrames) override;
     void resetPlayHead() { mReadFrameIndex = 0; };
-    void setPlaying(bool isPlaying) { mIsPlaying = isPlaying; resetPlayHead(); };
+    void setPlaying(bool isPlaying) override { mIsPlaying = isPlaying; resetPlayHead(); };
     void setLooping(bool isLooping) { mIsLooping = isLooping; };
 
 private:
@@ -38,6 +36,7 @@ private:
     std::atomic<bool> mIsLooping { false };
     std::shared_ptr<DataSource> mSource;
 
+    void renderFrames(float *targetData, int64_t sourceOffset, int64_t numSamples);
     void renderSilence(float*, int32_t);
 };
 
@@ -0,0 +1,43 @@
+#ifndef METRONOMEPLUS_SAMPLECONVERSION_H
+#define METRONOMEPLUS_SAMPLECONVERSION_H
+
+#include <cstdint>
+#include "../utils/Simd.h"
+
+constexpr float kPcm16Scale = 1.0f / 32768;
+
+/**
+ * Converts signed 16-bit PCM to floats in [-1, 1). Same result as `oboe::convertPcm16ToFloat` but
+ * kept here so it can be built and benchmarked on the host. Fast enough to run in the render
+ * callback, eight samples per step.
+ */
+inline void convertPcm16ToFloat(const int16_t *source, float *destination, int64_t numSamples) {
+    int64_t i = 0;
+
+#if METRONOMEPLUS_NEON
+    const float32x4_t scale = vdupq_n_f32(kPcm16Scale);
+    for (; i + 8 <= numSamples; i += 8) {
+        const int16x8_t samples = vld1q_s16(&source[i]);
+        vst1q_f32(&destination[i],
+                  vmulq_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(samples))), scale));
+        vst1q_f32(&destination[i + 4],
+                  vmulq_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(samples))), scale));
+    }
+#elif METRONOMEPLUS_SSE2
+    const __m128 scale = _mm_set1_ps(kPcm16Scale);
+    for (; i + 8 <= numSamples; i += 8) {
+        const __m128i samples = _mm_loadu_si128(reinterpret_cast<const __m128i *>(&source[i]));
+        // Interleaving a sample with itself and shifting back sign extends it to 32 bits
+        const __m128i low = _mm_srai_epi32(_mm_unpacklo_epi16(samples, samples), 16);
+        const __m128i high = _mm_srai_epi32(_mm_unpackhi_epi16(samples, samples), 16);
+        _mm_storeu_ps(&destination[i], _mm_mul_ps(_mm_cvtepi32_ps(low), scale));
+        _mm_storeu_ps(&destination[i + 4], _mm_mul_ps(_mm_cvtepi32_ps(high), scale));
+    }
+#endif
+
+    for (; i < numSamples; ++i) {
+        destination[i] = source[i] * kPcm16Scale;
+    }
+}
+
+#endif //METRONOMEPLUS_SAMPLECONVERSION_H
@@ -0,0 +1,199 @@
+#include <algorithm>
+#include <cstring>
+
+#include "Sequencer.h"
+
+namespace {
+
+// Queued in place of a song to go back to the pattern
+const SongTimeline kPatternSong{};
+
+}
+
+void Sequencer::renderAudio(float *audioData, int32_t numFrames) {
+
+    applyPendingChanges();
+
+    const int32_t channelCount = mMixer.getChannelCount();
+    int32_t framesRendered = static_cast<int32_t>(std::min<int64_t>(mHeldFrames, numFrames));
+    if (framesRendered > 0) {
+        memset(audioData, 0, sizeof(float) * framesRendered * channelCount);
+        mHeldFrames -= framesRendered;
+    }
+
+    while (framesRendered < numFrames) {
+        int64_t framesToRender = numFrames - framesRendered;
+
+        if (mIsRunning) {
+            if (mNextBeatFrame <= mFramePosition) {
+                advanceBeat(true);
+            }
+            // Stop the block right before the next onset so it can start on its exact frame
+            framesToRender = std::min(framesToRender, mNextBeatFrame - mFramePosition);
+        }
+
+        mMixer.renderAudio(&audioData[framesRendered * channelCount],
+                           static_cast<int32_t>(framesToRender));
+
+        framesRendered += static_cast<int32_t>(framesToRender);
+        mFramePosition += framesToRender;
+    }
+
+    mFramesUntilNextBeat.store(mIsRunning ? mNextBeatFrame - mFramePosition + mHeldFrames : 0,
+                               std::memory_order_relaxed);
+}
+
+void Sequencer::setBeats(const std::vector<Beat> &beats) {
+    const int32_t beatCount = std::min(static_cast<int32_t>(beats.size()), kMaxBeats);
+
+    for (int32_t i = 0; i < beatCount; ++i) {
+        mPattern[i].store(static_cast<int8_t>(beats[i].stateDto), std::memory_order_relaxed);
+    }
+    mBeatCount.store(beatCount, std::memory_order_release);
+}
+
+void Sequencer::start() {
+    mIsRestartPending.store(true, std::memory_order_relaxed);
+    mIsPlaying.store(true, std::memory_order_release);
+}
+
+void Sequencer::queueSong(const SongTimeline *song) {
+    mQueuedSong.store(song != nullptr ? song : &kPatternSong, std::memory_order_release);
+}
+
+void Sequencer::seekTo(int64_t framePosition) {
+
+    applyPendingChanges();
+
+    if (framePosition <= mFramePosition) {
+        mHeldFrames = mFramePosition - framePosition;
+        return;
+    }
+
+    mHeldFrames = 0;
+    mFramePosition = framePosition;
+
+    if (mIsRunning) {
+        while (mNextBeatFrame < mFramePosition) {
+            advanceBeat(false);
+        }
+    }
+}
+
+void Sequencer::applyPendingChanges() {
+
+    mIsRunning = mIsPlaying.load(std::memory_order_acquire);
+
+    // Songs carry their own tempo, the requested BPM only applies to the pattern
+    const int32_t bpm = mRequestedBPM.load(std::memory_order_relaxed);
+    const bool isTempoChanged = mSong == nullptr && bpm > 0 && bpm != mBPM;
+    if (isTempoChanged) {
+        mBPM = bpm;
+    }
+
+    if (mIsRestartPending.exchange(false, std::memory_order_relaxed)) {
+        mNextBeatIndex = 0;
+        mBarIndex = 0;
+        restartGrid(mFramePosition);
+        return;
+    }
+
+    if (!isTempoChanged || !mIsRunning) return;
+
+    // Continue the new tempo from the last beat that sounded. When speeding up the next beat may
+    // already be overdue, in which case it is played right away and the grid restarts there.
+    restartGrid(mLastBeatFrame);
+    mBeatsSinceOrigin = 1;
+    mNextBeatFrame = beatFrame(mBeatsSinceOrigin);
+    if (mNextBeatFrame < mFramePosition) {
+        restartGrid(mFramePosition);
+    }
+}
+
+void Sequencer::restartGrid(int64_t originFrame) {
+    mGridOriginFrame = originFrame;
+    mBeatsSinceOrigin = 0;
+    mNextBeatFrame = originFrame;
+}
+
+void Sequencer::startBar() {
+
+    const SongTimeline *queued = mQueuedSong.exchange(nullptr, std::memory_order_acquire);
+    if (queued != nullptr) {
+        mSong = queued != &kPatternSong ? queued : nullptr;
+        mBarIndex = 0;
+    }
+
+    if (mSong == nullptr) return;
+
+    // A tempo change takes effect from this bar's downbeat, which is still on the old grid
+    const int32_t bpm = mSong->bars[mBarIndex].bpm;
+    if (bpm != mBPM) {
+        mBPM = bpm;
+        restartGrid(mNextBeatFrame);
+    }
+}
+
+void Sequencer::advanceBeat(bool isAudible) {
+
+    if (mNextBeatIndex == 0) {
+        startBar();
+    }
+
+    int32_t beatCount;
+    int32_t beatIndex = mNextBeatIndex;
+    BeatState state = BeatState::Silence;
+    bool isCountIn = false;
+
+    if (mSong != nullptr) {
+        const ProgramBar &bar = mSong->bars[mBarIndex];
+        beatCount = bar.beatCount;
+        isCountIn = (bar.flags & kProgramBarCountIn) != 0;
+        if ((bar.flags & kProgramBarMuted) == 0) {
+            state = static_cast<BeatState>(mSong->beats[bar.firstBeat + beatIndex]);
+        }
+    } else {
+        beatCount = mBeatCount.load(std::memory_order_acquire);
+        if (beatCount > 0) {
+            beatIndex %= beatCount;
+            state = static_cast<BeatState>(mPattern[beatIndex].load(std::memory_order_relaxed));
+        }
+    }
+
+    if (beatCount > 0) {
+        if (isAudible) {
+            IPlayableAudio *player = nullptr;
+            if (isCountIn) {
+                player = mCountInPlayers[state].load(std::memory_order_acquire);
+            }
+            if (player == nullptr) {
+                player = mPlayers[state].load(std::memory_order_acquire);
+            }
+            if (player != nullptr) {
+                player->setPlaying(true);
+            }
+
+            BeatListener *listener = mBeatListener.load(std::memory_order_acquire);
+            if (listener != nullptr) {
+                listener->onBeat(mNextBeatFrame);
+            }
+        }
+
+        mLastBeatIndex.store(beatIndex, std::memory_order_relaxed);
+        mBeatSerial.fetch_add(1, std::memory_order_release);
+        mNextBeatIndex = (beatIndex + 1) % beatCount;
+
+        if (mSong != nullptr && mNextBeatIndex == 0 && ++mBarIndex >= mSong->barCount) {
+            mBarIndex = mSong->loopBar;
+        }
+    }
+
+    mLastBeatFrame = mNextBeatFrame;
+    mNextBeatFrame = beatFrame(++mBeatsSinceOrigin);
+}
+
+int64_t Sequencer::beatFrame(int64_t beatNumber) const {
+    // Computed from the grid origin every time so rounding never accumulates into drift
+    const int64_t framesPerMinute = static_cast<int64_t>(mSampleRate) * 60;
+    return mGridOriginFrame + (beatNumber * framesPerMinute + mBPM / 2) / mBPM;
+}
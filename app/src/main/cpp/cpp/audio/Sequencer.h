@@ -0,0 +1,128 @@
+#ifndef METRONOMEPLUS_SEQUENCER_H
+#define METRONOMEPLUS_SEQUENCER_H
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+#include "BeatListener.h"
+#include "IPlayableAudio.h"
+#include "Mixer.h"
+#include "../model/Beat.h"
+#include "../program/Program.h"
+
+/**
+ * Schedules the beats on the audio thread. Onsets lie on an ideal grid derived from the BPM and
+ * the sample rate, and the render block is split at every onset so each beat starts on its exact
+ * frame regardless of how many frames the stream asks for per callback.
+ *
+ * Beats come either from the pattern set with `setBeats`/`setBPM`, or bar by bar from a song of a
+ * compiled Program (see `queueSong`), which also carries its own tempo map.
+ *
+ * The setters are safe to call from any thread; changes are picked up on the next render.
+ */
+class Sequencer : public IRenderableAudio {
+
+public:
+    Sequencer(Mixer &mixer, int32_t sampleRate)
+        : mMixer(mixer)
+        , mSampleRate(sampleRate)
+    {};
+
+    void renderAudio(float *audioData, int32_t numFrames) override;
+
+    void setPlayer(BeatState state, IPlayableAudio *player) {
+        mPlayers[state].store(player, std::memory_order_release);
+    };
+    /**
+     * Player for the beats of a song's count-in bars, so they can be mixed to their own bus.
+     * Count-in beats without one use the player set with `setPlayer`.
+     */
+    void setCountInPlayer(BeatState state, IPlayableAudio *player) {
+        mCountInPlayers[state].store(player, std::memory_order_release);
+    };
+    void setBeatListener(BeatListener *listener) {
+        mBeatListener.store(listener, std::memory_order_release);
+    };
+    void setBPM(int bpm) { mRequestedBPM.store(bpm, std::memory_order_relaxed); };
+    void setBeats(const std::vector<Beat> &beats);
+    void start();
+    void stop() { mIsPlaying.store(false, std::memory_order_relaxed); };
+    bool isPlaying() const { return mIsPlaying.load(std::memory_order_relaxed); };
+
+    /**
+     * Plays `song` from its first bar, starting at the next bar line so the switch is gapless.
+     * Passing nullptr goes back to the pattern set with `setBeats`. The song must stay valid until
+     * another one has been queued and started.
+     */
+    void queueSong(const SongTimeline *song);
+
+    /**
+     * Advances the clock by `numFrames` without rendering, dropping any beats that fall inside
+     * the gap. Must not be called concurrently with `renderAudio`.
+     */
+    void skipFrames(int64_t numFrames) { seekTo(getFramePosition() + numFrames); };
+
+    /**
+     * Moves the clock so the next `renderAudio` call starts on `framePosition`, leaving the beat
+     * grid where it is. Used to keep the beat phase anchored to wall-clock time while the stream
+     * is reopened. Seeking ahead drops the beats in between like `skipFrames`. Seeking back means
+     * rendered frames were never heard, so that many frames of silence are played before the clock
+     * carries on from where it was: their beats are lost but everything after stays on the grid.
+     * Must not be called concurrently with `renderAudio`.
+     */
+    void seekTo(int64_t framePosition);
+
+    int32_t getSampleRate() const { return mSampleRate; };
+    int32_t getLastBeatIndex() const { return mLastBeatIndex.load(std::memory_order_relaxed); };
+    uint32_t getBeatSerial() const { return mBeatSerial.load(std::memory_order_acquire); };
+    int64_t getFramesUntilNextBeat() const {
+        return mFramesUntilNextBeat.load(std::memory_order_relaxed);
+    };
+
+    /**
+     * Frame the next `renderAudio` call starts on. Audio thread only.
+     */
+    int64_t getFramePosition() const { return mFramePosition - mHeldFrames; };
+
+private:
+    Mixer &mMixer;
+    const int32_t mSampleRate;
+    std::array<std::atomic<IPlayableAudio *>, kBeatStateCount> mPlayers{};
+    std::array<std::atomic<IPlayableAudio *>, kBeatStateCount> mCountInPlayers{};
+
+    std::array<std::atomic<int8_t>, kMaxBeats> mPattern{};
+    std::atomic<int32_t> mBeatCount{0};
+    std::atomic<int32_t> mRequestedBPM{60};
+    std::atomic<bool> mIsPlaying{false};
+    std::atomic<bool> mIsRestartPending{false};
+    std::atomic<const SongTimeline *> mQueuedSong{nullptr};
+    std::atomic<BeatListener *> mBeatListener{nullptr};
+
+    std::atomic<int32_t> mLastBeatIndex{0};
+    std::atomic<uint32_t> mBeatSerial{0};
+    std::atomic<int64_t> mFramesUntilNextBeat{0};
+
+    // Audio thread state
+    bool mIsRunning = false;
+    int32_t mBPM = 60;
+    int64_t mFramePosition = 0;
+    // Silence still to be played before mFramePosition, see `seekTo`
+    int64_t mHeldFrames = 0;
+    int64_t mGridOriginFrame = 0;
+    int64_t mBeatsSinceOrigin = 0;
+    int64_t mLastBeatFrame = 0;
+    int64_t mNextBeatFrame = 0;
+    int32_t mNextBeatIndex = 0;
+    const SongTimeline *mSong = nullptr;
+    uint32_t mBarIndex = 0;
+
+    void applyPendingChanges();
+    void startBar();
+    void restartGrid(int64_t originFrame);
+    void advanceBeat(bool isAudible);
+    int64_t beatFrame(int64_t beatNumber) const;
+};
+
+#endif //METRONOMEPLUS_SEQUENCER_H
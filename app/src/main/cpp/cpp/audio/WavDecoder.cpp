@@ -0,0 +1,117 @@
+#include <cstring>
+
+#include "WavDecoder.h"
+#include "SampleConversion.h"
+#include "../utils/Logging.h"
+
+constexpr uint16_t kWavFormatPcm { 1 };
+constexpr size_t kRiffHeaderSize { 12 };
+constexpr size_t kChunkHeaderSize { 8 };
+constexpr size_t kFormatChunkMinSize { 16 };
+
+namespace {
+
+uint16_t readUint16(const uint8_t *data) {
+    return static_cast<uint16_t>(data[0] | (data[1] << 8));
+}
+
+uint32_t readUint32(const uint8_t *data) {
+    return static_cast<uint32_t>(data[0])
+           | (static_cast<uint32_t>(data[1]) << 8)
+           | (static_cast<uint32_t>(data[2]) << 16)
+           | (static_cast<uint32_t>(data[3]) << 24);
+}
+
+}
+
+bool WavDecoder::parse(const uint8_t *fileData, size_t fileSize, WavInfo *info) {
+
+    if (fileSize < kRiffHeaderSize
+        || memcmp(fileData, "RIFF", 4) != 0
+        || memcmp(fileData + 8, "WAVE", 4) != 0) {
+        return false;
+    }
+
+    bool hasFormat = false;
+    uint16_t formatTag = 0;
+    size_t offset = kRiffHeaderSize;
+
+    while (offset + kChunkHeaderSize <= fileSize) {
+        const uint8_t *chunk = fileData + offset;
+        const size_t chunkSize = readUint32(chunk + 4);
+        const uint8_t *chunkData = chunk + kChunkHeaderSize;
+        const size_t available = fileSize - offset - kChunkHeaderSize;
+
+        if (memcmp(chunk, "fmt ", 4) == 0) {
+            if (chunkSize < kFormatChunkMinSize || chunkSize > available) return false;
+            formatTag = readUint16(chunkData);
+            info->properties.channelCount = readUint16(chunkData + 2);
+            info->properties.sampleRate = static_cast<int32_t>(readUint32(chunkData + 4));
+            info->bitsPerSample = readUint16(chunkData + 14);
+            hasFormat = true;
+
+        } else if (memcmp(chunk, "data", 4) == 0) {
+            if (!hasFormat || formatTag != kWavFormatPcm) return false;
+            info->sampleData = chunkData;
+            // Tolerate truncated files, some encoders leave a stale size in the header
+            info->sampleDataSize = chunkSize < available ? chunkSize : available;
+            return true;
+        }
+
+        // Chunks are padded to an even number of bytes
+        offset += kChunkHeaderSize + chunkSize + (chunkSize & 1);
+    }
+
+    return false;
+}
+
+bool WavDecoder::parseMatching(const uint8_t *fileData, size_t fileSize,
+                               AudioProperties targetProperties, WavInfo *info) {
+
+    if (!parse(fileData, fileSize, info)) {
+        return false;
+    }
+
+    if (info->bitsPerSample != 16
+        || info->properties.channelCount != targetProperties.channelCount
+        || info->properties.sampleRate != targetProperties.sampleRate) {
+        LOGD("WAV format (%d bit, %d ch, %d Hz) does not match the target",
+             info->bitsPerSample, info->properties.channelCount, info->properties.sampleRate);
+        return false;
+    }
+    return true;
+}
+
+int64_t WavDecoder::decode(const uint8_t *fileData, size_t fileSize,
+                           AudioProperties targetProperties,
+                           std::unique_ptr<float[]> &outputBuffer) {
+
+    WavInfo info{};
+    if (!parseMatching(fileData, fileSize, targetProperties, &info)) {
+        return 0;
+    }
+
+    const int64_t numSamples = info.sampleDataSize / sizeof(int16_t);
+    outputBuffer = std::make_unique<float[]>(numSamples);
+
+    // RIFF chunks start on even offsets so the samples are suitably aligned
+    convertPcm16ToFloat(reinterpret_cast<const int16_t *>(info.sampleData),
+                        outputBuffer.get(),
+                        numSamples);
+    return numSamples;
+}
+
+int64_t WavDecoder::decode(const uint8_t *fileData, size_t fileSize,
+                           AudioProperties targetProperties,
+                           std::unique_ptr<int16_t[]> &outputBuffer) {
+
+    WavInfo info{};
+    if (!parseMatching(fileData, fileSize, targetProperties, &info)) {
+        return 0;
+    }
+
+    const int64_t numSamples = info.sampleDataSize / sizeof(int16_t);
+    outputBuffer = std::make_unique<int16_t[]>(numSamples);
+    memcpy(outputBuffer.get(), info.sampleData, numSamples * sizeof(int16_t));
+    return numSamples;
+}
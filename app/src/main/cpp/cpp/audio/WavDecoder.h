@@ -0,0 +1,49 @@
+#ifndef METRONOMEPLUS_WAVDECODER_H
+#define METRONOMEPLUS_WAVDECODER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include "../utils/Constants.h"
+
+struct WavInfo {
+    AudioProperties properties;
+    int32_t bitsPerSample;
+    const uint8_t *sampleData;
+    size_t sampleDataSize;
+};
+
+/**
+ * Reads uncompressed RIFF/WAVE files directly from memory. Off the device the NDK media codecs are
+ * not available, so this is how the host tests and benchmarks load the bundled beat sounds.
+ */
+class WavDecoder {
+
+public:
+    /**
+     * Locates the format and sample data of a WAV file. Returns false if the data is not a
+     * well-formed WAV file.
+     */
+    static bool parse(const uint8_t *fileData, size_t fileSize, WavInfo *info);
+
+    /**
+     * Decodes a 16-bit PCM WAV file into floats. Returns the number of samples written to
+     * `outputBuffer`, or 0 if the file is not 16-bit PCM or does not match `targetProperties`.
+     */
+    static int64_t decode(const uint8_t *fileData, size_t fileSize,
+                          AudioProperties targetProperties,
+                          std::unique_ptr<float[]> &outputBuffer);
+
+    /**
+     * Same as above but keeps the samples as 16-bit PCM, for a Pcm16DataSource.
+     */
+    static int64_t decode(const uint8_t *fileData, size_t fileSize,
+                          AudioProperties targetProperties,
+                          std::unique_ptr<int16_t[]> &outputBuffer);
+
+private:
+    static bool parseMatching(const uint8_t *fileData, size_t fileSize,
+                              AudioProperties targetProperties, WavInfo *info);
+};
+
+#endif //METRONOMEPLUS_WAVDECODER_H
@@ -33,7 +33,8 @@ Java_br_com_jonatas_metronomeplus_presenter_ui_MainActivity_helloC(JNIEnv *env,
 
 JNIEXPORT void JNICALL
 Java_br_com_jonatas_metronomeplus_data_engine_MetronomeEngineImpl_native_1onInit(JNIEnv *env, jobject instance,
-                                                                                 jobject asset_manager) {
+                                                                                 jobject asset_manager,
+                                                                                 jint channelCount) {
 
     AAssetManager *assetManager = AAssetManager_fromJava(env, asset_manager);
     if (assetManager == nullptr) {
@@ -41,8 +42,17 @@ Java_br_com_jonatas_metronomeplus_data_engine_MetronomeEngineImpl_native_1onInit
         return;
     }
 
-    metronome = std::make_unique<Metronome>(*assetManager);
-    metronome->init();
+    metronome = std::make_unique<Metronome>(*assetManager, (int32_t) channelCount);
+    Metronome *engine = metronome.get();
+    metronome->init([engine](bool isReady) {
+        if (!isReady) {
+            LOGE("Metronome failed to initialize");
+            return;
+        }
+        StartupMetrics metrics = engine->getStartupMetrics();
+        LOGI("Metronome ready in %lld us (stream open %lld us)",
+             (long long) metrics.readyUs, (long long) metrics.streamOpenUs);
+    });
 }
 
 JNIEXPORT void JNICALL
@@ -108,6 +118,100 @@ Java_br_com_jonatas_metronomeplus_data_engine_MetronomeEngineImpl_native_1SetBea
     metronome->setBeats(beats);
 }
 
+JNIEXPORT jint JNICALL
+Java_br_com_jonatas_metronomeplus_data_engine_MetronomeEngineImpl_native_1LoadProgram(JNIEnv *env, jobject instance,
+                                                                                      jstring jPath) {
+    if (!metronome) return -1;
+
+    const char *path = env->GetStringUTFChars(jPath, nullptr);
+    jint songCount = metronome->loadProgram(path);
+    env->ReleaseStringUTFChars(jPath, path);
+    return songCount;
+}
+
+JNIEXPORT jboolean JNICALL
+Java_br_com_jonatas_metronomeplus_data_engine_MetronomeEngineImpl_native_1SelectSong(JNIEnv *env, jobject instance,
+                                                                                     jint songIndex) {
+    if (!metronome) return JNI_FALSE;
+
+    return metronome->selectSong(songIndex) ? JNI_TRUE : JNI_FALSE;
+}
+
+JNIEXPORT jboolean JNICALL
+Java_br_com_jonatas_metronomeplus_data_engine_MetronomeEngineImpl_native_1setTimingAnalysisEnabled(JNIEnv *env,
+                                                                                                  jobject instance,
+                                                                                                  jboolean isEnabled) {
+    if (!metronome) return JNI_FALSE;
+
+    return metronome->setTimingAnalysisEnabled(isEnabled) ? JNI_TRUE : JNI_FALSE;
+}
+
+JNIEXPORT void JNICALL
+Java_br_com_jonatas_metronomeplus_data_engine_MetronomeEngineImpl_native_1setLatencyCompensationMs(JNIEnv *env,
+                                                                                                  jobject instance,
+                                                                                                  jint compensationMs) {
+    if (metronome) {
+        metronome->setLatencyCompensationMs(compensationMs);
+    }
+}
+
+JNIEXPORT jfloatArray JNICALL
+Java_br_com_jonatas_metronomeplus_data_engine_MetronomeEngineImpl_native_1drainTimingDeviations(JNIEnv *env,
+                                                                                               jobject instance) {
+    TimingResult results[kTimingResultCapacity];
+    const int32_t resultCount = metronome
+            ? metronome->drainTimingResults(results, kTimingResultCapacity)
+            : 0;
+
+    float deviationsMs[kTimingResultCapacity];
+    for (int32_t i = 0; i < resultCount; ++i) {
+        deviationsMs[i] = results[i].deviationMs;
+    }
+
+    jfloatArray jDeviations = env->NewFloatArray(resultCount);
+    if (jDeviations != nullptr) {
+        env->SetFloatArrayRegion(jDeviations, 0, resultCount, deviationsMs);
+    }
+    return jDeviations;
+}
+
+JNIEXPORT void JNICALL
+Java_br_com_jonatas_metronomeplus_data_engine_MetronomeEngineImpl_native_1setSynthesizedClicks(JNIEnv *env,
+                                                                                              jobject instance,
+                                                                                              jboolean isSynthesized) {
+    if (metronome) {
+        metronome->setSynthesizedClicks(isSynthesized);
+    }
+}
+
+JNIEXPORT jfloat JNICALL
+Java_br_com_jonatas_metronomeplus_data_engine_MetronomeEngineImpl_native_1getGainReductionDb(JNIEnv *env,
+                                                                                            jobject instance) {
+    return metronome ? metronome->takeGainReductionDb() : 0;
+}
+
+JNIEXPORT void JNICALL
+Java_br_com_jonatas_metronomeplus_data_engine_MetronomeEngineImpl_native_1setBusRoute(JNIEnv *env,
+                                                                                      jobject instance,
+                                                                                      jint bus,
+                                                                                      jint leftChannel,
+                                                                                      jint rightChannel,
+                                                                                      jfloat gain) {
+    if (bus < 0 || bus >= kBusCount) {
+        LOGE("No output bus %d", bus);
+        return;
+    }
+    if (metronome) {
+        metronome->setBusRoute(static_cast<Bus>(bus), leftChannel, rightChannel, gain);
+    }
+}
+
+JNIEXPORT jint JNICALL
+Java_br_com_jonatas_metronomeplus_data_engine_MetronomeEngineImpl_native_1getOutputChannelCount(JNIEnv *env,
+                                                                                               jobject instance) {
+    return metronome ? metronome->getOutputChannelCount() : 0;
+}
+
 JNIEXPORT void JNICALL
 Java_br_com_jonatas_metronomeplus_data_engine_MetronomeEngineImpl_native_1onStartPlaying(JNIEnv *env,
                                                                                          jobject instance) {
@@ -124,6 +228,15 @@ Java_br_com_jonatas_metronomeplus_data_engine_MetronomeEngineImpl_native_1onStop
     }
 }
 
+JNIEXPORT void JNICALL
+Java_br_com_jonatas_metronomeplus_data_engine_MetronomeEngineImpl_native_1setPowerSavingMode(JNIEnv *env,
+                                                                                             jobject instance,
+                                                                                             jboolean isPowerSaving) {
+    if (metronome) {
+        metronome->setPowerSavingMode(isPowerSaving);
+    }
+}
+
 JNIEXPORT void JNICALL
 Java_br_com_jonatas_metronomeplus_data_engine_MetronomeEngineImpl_native_1setDefaultStreamValues(JNIEnv *env,
                                                                                                  jobject instance,
@@ -8,6 +8,9 @@ enum BeatState {
     Medium
 };
 
+constexpr int kBeatStateCount = 4;
+constexpr int kMaxBeats = 64;
+
 struct Beat {
     BeatState stateDto;
 };
@@ -0,0 +1,169 @@
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "Program.h"
+#include "../model/Beat.h"
+#include "../utils/Logging.h"
+
+namespace {
+
+bool fail(std::string *error, const std::string &message) {
+    if (error != nullptr) *error = message;
+    return false;
+}
+
+bool isSectionValid(uint32_t offset, uint64_t sectionSize, size_t fileSize) {
+    return offset % alignof(uint32_t) == 0 && offset + sectionSize <= fileSize;
+}
+
+}
+
+Program::Program(const uint8_t *data, size_t size, bool isMapped)
+    : mData(data)
+    , mSize(size)
+    , mIsMapped(isMapped) {
+
+    const auto *header = reinterpret_cast<const ProgramHeader *>(mData);
+    const auto *songs = reinterpret_cast<const ProgramSong *>(mData + header->songsOffset);
+    const auto *bars = reinterpret_cast<const ProgramBar *>(mData + header->barsOffset);
+    const uint8_t *beats = mData + header->beatsOffset;
+
+    mSongs.reserve(header->songCount);
+    for (uint16_t i = 0; i < header->songCount; ++i) {
+        mSongs.push_back({&bars[songs[i].firstBar], songs[i].barCount, songs[i].loopBar, beats});
+    }
+}
+
+Program::~Program() {
+    if (mIsMapped) {
+        munmap(const_cast<uint8_t *>(mData), mSize);
+    }
+}
+
+std::unique_ptr<Program> Program::fromFile(const char *path) {
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        LOGE("Could not open program %s", path);
+        return nullptr;
+    }
+
+    struct stat fileStat{};
+    if (fstat(fd, &fileStat) != 0 || fileStat.st_size == 0) {
+        LOGE("Could not read program %s", path);
+        close(fd);
+        return nullptr;
+    }
+
+    const auto size = static_cast<size_t>(fileStat.st_size);
+    void *mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapped == MAP_FAILED) {
+        LOGE("Could not map program %s", path);
+        return nullptr;
+    }
+
+    const auto *data = static_cast<const uint8_t *>(mapped);
+    std::string error;
+    if (!validate(data, size, &error)) {
+        LOGE("Invalid program %s: %s", path, error.c_str());
+        munmap(mapped, size);
+        return nullptr;
+    }
+
+    return std::unique_ptr<Program>(new Program(data, size, true));
+}
+
+std::unique_ptr<Program> Program::fromBuffer(const void *data, size_t size) {
+
+    const auto *bytes = static_cast<const uint8_t *>(data);
+    std::string error;
+    if (reinterpret_cast<uintptr_t>(bytes) % alignof(uint32_t) != 0) {
+        LOGE("Invalid program: buffer is not aligned");
+        return nullptr;
+    }
+    if (!validate(bytes, size, &error)) {
+        LOGE("Invalid program: %s", error.c_str());
+        return nullptr;
+    }
+
+    return std::unique_ptr<Program>(new Program(bytes, size, false));
+}
+
+bool Program::validate(const uint8_t *data, size_t size, std::string *error) {
+
+    if (size < sizeof(ProgramHeader)) {
+        return fail(error, "file is smaller than the header");
+    }
+
+    ProgramHeader header{};
+    memcpy(&header, data, sizeof(header));
+
+    if (memcmp(header.magic, kProgramMagic, sizeof(kProgramMagic)) != 0) {
+        return fail(error, "not a program file");
+    }
+    if (header.version != kProgramVersion) {
+        return fail(error, "unsupported version " + std::to_string(header.version));
+    }
+    if (!isSectionValid(header.songsOffset, uint64_t{header.songCount} * sizeof(ProgramSong), size)
+        || !isSectionValid(header.barsOffset, uint64_t{header.barCount} * sizeof(ProgramBar), size)
+        || !isSectionValid(header.beatsOffset, header.beatCount, size)) {
+        return fail(error, "section out of bounds or misaligned");
+    }
+
+    for (uint16_t i = 0; i < header.songCount; ++i) {
+        ProgramSong song{};
+        memcpy(&song, data + header.songsOffset + i * sizeof(ProgramSong), sizeof(song));
+        const std::string where = "song " + std::to_string(i) + ": ";
+
+        if (song.barCount == 0) {
+            return fail(error, where + "has no bars");
+        }
+        if (uint64_t{song.firstBar} + song.barCount > header.barCount) {
+            return fail(error, where + "bars out of bounds");
+        }
+        if (song.loopBar >= song.barCount) {
+            return fail(error, where + "loop bar out of bounds");
+        }
+    }
+
+    for (uint32_t i = 0; i < header.barCount; ++i) {
+        ProgramBar bar{};
+        memcpy(&bar, data + header.barsOffset + i * sizeof(ProgramBar), sizeof(bar));
+        const std::string where = "bar " + std::to_string(i) + ": ";
+
+        if (bar.bpm < kProgramMinBpm || bar.bpm > kProgramMaxBpm) {
+            return fail(error, where + "bpm out of range");
+        }
+        if (bar.beatCount == 0 || bar.beatCount > kMaxBeats) {
+            return fail(error, where + "beat count out of range");
+        }
+        if (uint64_t{bar.firstBeat} + bar.beatCount > header.beatCount) {
+            return fail(error, where + "beats out of bounds");
+        }
+    }
+
+    for (uint32_t i = 0; i < header.beatCount; ++i) {
+        if (data[header.beatsOffset + i] >= kBeatStateCount) {
+            return fail(error, "beat " + std::to_string(i) + ": unknown beat state");
+        }
+    }
+
+    return true;
+}
+
+const SongTimeline *Program::getSong(int32_t index) const {
+    if (index < 0 || index >= getSongCount()) return nullptr;
+    return &mSongs[index];
+}
+
+std::string Program::getSongName(int32_t index) const {
+    if (index < 0 || index >= getSongCount()) return "";
+
+    const auto *header = reinterpret_cast<const ProgramHeader *>(mData);
+    const auto *songs = reinterpret_cast<const ProgramSong *>(mData + header->songsOffset);
+    return std::string(songs[index].name, strnlen(songs[index].name, kProgramSongNameSize));
+}
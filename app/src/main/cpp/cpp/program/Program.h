@@ -0,0 +1,67 @@
+#ifndef METRONOMEPLUS_PROGRAM_H
+#define METRONOMEPLUS_PROGRAM_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "ProgramFormat.h"
+
+/**
+ * The part of a song the Sequencer needs, pointing straight into the program's memory. Switching
+ * songs is a matter of handing the Sequencer another SongTimeline pointer.
+ */
+struct SongTimeline {
+    const ProgramBar *bars;
+    uint32_t barCount;
+    uint32_t loopBar;
+    const uint8_t *beats;
+};
+
+/**
+ * A validated, read-only view over a compiled program (see ProgramFormat.h), either memory mapped
+ * from a file or wrapping a buffer owned by someone else. The SongTimelines it hands out stay valid
+ * for the lifetime of the Program.
+ */
+class Program {
+
+public:
+    ~Program();
+
+    /**
+     * Maps the program file at `path`. Returns nullptr if the file cannot be read or is not a
+     * valid program.
+     */
+    static std::unique_ptr<Program> fromFile(const char *path);
+
+    /**
+     * Wraps a program held in memory, e.g. an asset buffer. The buffer must outlive the Program
+     * and be 4-byte aligned. Returns nullptr if the data is not a valid program.
+     */
+    static std::unique_ptr<Program> fromBuffer(const void *data, size_t size);
+
+    /**
+     * Checks that `data` is a well-formed program that is safe to play. On failure `error`
+     * describes the first problem found.
+     */
+    static bool validate(const uint8_t *data, size_t size, std::string *error);
+
+    int32_t getSongCount() const { return static_cast<int32_t>(mSongs.size()); }
+    const SongTimeline *getSong(int32_t index) const;
+    std::string getSongName(int32_t index) const;
+
+    Program(const Program &) = delete;
+    Program &operator=(const Program &) = delete;
+
+private:
+    Program(const uint8_t *data, size_t size, bool isMapped);
+
+    const uint8_t *mData;
+    const size_t mSize;
+    const bool mIsMapped;
+    std::vector<SongTimeline> mSongs;
+};
+
+#endif //METRONOMEPLUS_PROGRAM_H
@@ -0,0 +1,185 @@
+#include <cstring>
+#include <sstream>
+
+#include "ProgramCompiler.h"
+#include "Program.h"
+#include "ProgramFormat.h"
+#include "../model/Beat.h"
+
+namespace {
+
+struct SongSource {
+    std::string name;
+    std::vector<ProgramBar> bars;
+    uint32_t loopBar = 0;
+    bool hasLoopBar = false;
+};
+
+bool parseBeat(const std::string &token, uint8_t *state) {
+    if (token == "A") *state = BeatState::Accent;
+    else if (token == "M") *state = BeatState::Medium;
+    else if (token == "N") *state = BeatState::Normal;
+    else if (token == "S") *state = BeatState::Silence;
+    else return false;
+    return true;
+}
+
+bool parseNumber(const std::string &token, long min, long max, long *value) {
+    if (token.empty() || token.find_first_not_of("0123456789") != std::string::npos) return false;
+    *value = std::strtol(token.c_str(), nullptr, 10);
+    return *value >= min && *value <= max;
+}
+
+template<typename T>
+void append(std::vector<uint8_t> *output, const T &value) {
+    const auto *bytes = reinterpret_cast<const uint8_t *>(&value);
+    output->insert(output->end(), bytes, bytes + sizeof(T));
+}
+
+}
+
+bool ProgramCompiler::compile(const std::string &source, std::vector<uint8_t> *output,
+                              std::string *error) {
+
+    std::vector<SongSource> songs;
+    std::vector<uint8_t> beats;
+    std::istringstream lines(source);
+    std::string line;
+    int lineNumber = 0;
+
+    auto fail = [&](const std::string &message) {
+        *error = "line " + std::to_string(lineNumber) + ": " + message;
+        return false;
+    };
+
+    while (std::getline(lines, line)) {
+        ++lineNumber;
+        line = line.substr(0, line.find('#'));
+
+        std::istringstream tokens(line);
+        std::string keyword;
+        if (!(tokens >> keyword)) continue;
+
+        if (keyword == "song") {
+            SongSource song;
+            std::getline(tokens >> std::ws, song.name);
+            if (song.name.empty()) return fail("song needs a name");
+            if (song.name.size() > kProgramSongNameSize) return fail("song name is too long");
+            songs.push_back(song);
+            continue;
+        }
+
+        if (keyword != "bar" && keyword != "count-in" && keyword != "gap") {
+            return fail("unknown statement '" + keyword + "'");
+        }
+        if (songs.empty()) return fail("bars must follow a song statement");
+
+        std::vector<std::string> arguments;
+        for (std::string token; tokens >> token;) arguments.push_back(token);
+
+        long repeat = 1;
+        if (!arguments.empty() && arguments.back()[0] == 'x') {
+            if (!parseNumber(arguments.back().substr(1), 1, 10000, &repeat)) {
+                return fail("invalid repeat count '" + arguments.back() + "'");
+            }
+            arguments.pop_back();
+        }
+
+        long bpm;
+        if (arguments.empty() || !parseNumber(arguments[0], kProgramMinBpm, kProgramMaxBpm, &bpm)) {
+            return fail("expected a bpm between " + std::to_string(kProgramMinBpm) + " and "
+                        + std::to_string(kProgramMaxBpm));
+        }
+
+        std::vector<uint8_t> barBeats;
+        if (keyword == "gap") {
+            long beatCount;
+            if (arguments.size() != 2 || !parseNumber(arguments[1], 1, kMaxBeats, &beatCount)) {
+                return fail("gap expects a bpm and a beat count up to " + std::to_string(kMaxBeats));
+            }
+            barBeats.assign(static_cast<size_t>(beatCount), BeatState::Silence);
+        } else {
+            for (size_t i = 1; i < arguments.size(); ++i) {
+                uint8_t state;
+                if (!parseBeat(arguments[i], &state)) {
+                    return fail("unknown beat '" + arguments[i] + "'");
+                }
+                barBeats.push_back(state);
+            }
+            if (barBeats.empty() || barBeats.size() > kMaxBeats) {
+                return fail("a bar needs between 1 and " + std::to_string(kMaxBeats) + " beats");
+            }
+        }
+
+        ProgramBar bar{};
+        bar.firstBeat = static_cast<uint32_t>(beats.size());
+        bar.bpm = static_cast<uint16_t>(bpm);
+        bar.beatCount = static_cast<uint8_t>(barBeats.size());
+        bar.flags = keyword == "count-in" ? kProgramBarCountIn
+                  : keyword == "gap" ? kProgramBarMuted
+                  : 0;
+        beats.insert(beats.end(), barBeats.begin(), barBeats.end());
+
+        SongSource &song = songs.back();
+        if (keyword == "count-in" && song.hasLoopBar) {
+            return fail("count-in bars must come first in a song");
+        }
+        if (keyword != "count-in" && !song.hasLoopBar) {
+            song.loopBar = static_cast<uint32_t>(song.bars.size());
+            song.hasLoopBar = true;
+        }
+        // Repeated bars share their beats
+        song.bars.insert(song.bars.end(), static_cast<size_t>(repeat), bar);
+    }
+
+    if (songs.empty()) {
+        *error = "no songs";
+        return false;
+    }
+    if (songs.size() > UINT16_MAX) {
+        *error = "too many songs";
+        return false;
+    }
+
+    ProgramHeader header{};
+    memcpy(header.magic, kProgramMagic, sizeof(kProgramMagic));
+    header.version = kProgramVersion;
+    header.songCount = static_cast<uint16_t>(songs.size());
+    header.beatCount = static_cast<uint32_t>(beats.size());
+    for (const SongSource &song : songs) {
+        header.barCount += static_cast<uint32_t>(song.bars.size());
+    }
+    header.songsOffset = sizeof(ProgramHeader);
+    header.barsOffset = header.songsOffset + header.songCount * sizeof(ProgramSong);
+    header.beatsOffset = header.barsOffset + header.barCount * sizeof(ProgramBar);
+
+    output->clear();
+    append(output, header);
+
+    uint32_t firstBar = 0;
+    for (const SongSource &song : songs) {
+        if (song.bars.empty()) {
+            *error = "song '" + song.name + "' has no bars";
+            return false;
+        }
+        if (!song.hasLoopBar) {
+            *error = "song '" + song.name + "' only has count-in bars";
+            return false;
+        }
+        ProgramSong entry{};
+        memcpy(entry.name, song.name.data(), song.name.size());
+        entry.firstBar = firstBar;
+        entry.barCount = static_cast<uint32_t>(song.bars.size());
+        entry.loopBar = song.loopBar;
+        append(output, entry);
+        firstBar += entry.barCount;
+    }
+    for (const SongSource &song : songs) {
+        for (const ProgramBar &bar : song.bars) {
+            append(output, bar);
+        }
+    }
+    output->insert(output->end(), beats.begin(), beats.end());
+
+    return Program::validate(output->data(), output->size(), error);
+}
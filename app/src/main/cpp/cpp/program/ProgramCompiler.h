@@ -0,0 +1,31 @@
+#ifndef METRONOMEPLUS_PROGRAMCOMPILER_H
+#define METRONOMEPLUS_PROGRAMCOMPILER_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * Compiles the text form of a practice program into the binary format read by Program. One
+ * statement per line, `#` starts a comment:
+ *
+ *   song <name>                      starts a new song
+ *   count-in <bpm> <beats> [x<n>]    count-in bar(s), not repeated when the song loops
+ *   bar <bpm> <beats> [x<n>]         regular bar(s)
+ *   gap <bpm> <beat count> [x<n>]    muted bar(s)
+ *
+ * where <beats> is a list of A (accent), M (medium), N (normal) and S (silence), e.g.
+ * `bar 120 A N N N x8`. A song loops back to its first regular bar after its last bar.
+ */
+class ProgramCompiler {
+
+public:
+    /**
+     * Returns false and describes the problem (with its line number) in `error` if the source is
+     * invalid. Otherwise `output` holds the compiled program.
+     */
+    static bool compile(const std::string &source, std::vector<uint8_t> *output,
+                        std::string *error);
+};
+
+#endif //METRONOMEPLUS_PROGRAMCOMPILER_H
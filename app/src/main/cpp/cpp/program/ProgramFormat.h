@@ -0,0 +1,62 @@
+#ifndef METRONOMEPLUS_PROGRAMFORMAT_H
+#define METRONOMEPLUS_PROGRAMFORMAT_H
+
+#include <cstdint>
+
+/**
+ * On-disk layout of a compiled practice program (a setlist of songs). The file is designed to be
+ * memory mapped and used in place: every section is 4-byte aligned, all integers are little endian
+ * and there are no pointers, only offsets from the start of the file.
+ *
+ *   ProgramHeader
+ *   ProgramSong[songCount]   at songsOffset
+ *   ProgramBar[barCount]     at barsOffset
+ *   uint8_t[beatCount]       at beatsOffset, one BeatState per beat
+ */
+
+constexpr char kProgramMagic[4]{'M', 'P', 'P', 'G'};
+constexpr uint16_t kProgramVersion = 1;
+constexpr int kProgramSongNameSize = 32;
+constexpr uint16_t kProgramMinBpm = 1;
+constexpr uint16_t kProgramMaxBpm = 1000;
+
+enum ProgramBarFlags : uint8_t {
+    // Played before the song proper and not repeated when the song loops
+    kProgramBarCountIn = 1 << 0,
+    // Time passes but no beat is heard
+    kProgramBarMuted = 1 << 1,
+};
+
+struct ProgramHeader {
+    char magic[4];
+    uint16_t version;
+    uint16_t songCount;
+    uint32_t barCount;
+    uint32_t beatCount;
+    uint32_t songsOffset;
+    uint32_t barsOffset;
+    uint32_t beatsOffset;
+};
+
+struct ProgramSong {
+    char name[kProgramSongNameSize];
+    // Index into the program's bars
+    uint32_t firstBar;
+    uint32_t barCount;
+    // Bar (relative to firstBar) the song continues from once its last bar has been played
+    uint32_t loopBar;
+};
+
+struct ProgramBar {
+    // Index into the program's beats
+    uint32_t firstBeat;
+    uint16_t bpm;
+    uint8_t beatCount;
+    uint8_t flags;
+};
+
+static_assert(sizeof(ProgramHeader) == 28, "ProgramHeader layout changed");
+static_assert(sizeof(ProgramSong) == 44, "ProgramSong layout changed");
+static_assert(sizeof(ProgramBar) == 8, "ProgramBar layout changed");
+
+#endif //METRONOMEPLUS_PROGRAMFORMAT_H
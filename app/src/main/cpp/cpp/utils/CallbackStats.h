@@ -0,0 +1,59 @@
+#ifndef METRONOMEPLUS_CALLBACKSTATS_H
+#define METRONOMEPLUS_CALLBACKSTATS_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <ctime>
+
+/**
+ * Counts audio callbacks (i.e. wakeups) and the CPU time spent inside them. `record` is called
+ * from the audio thread; the getters may be called from any thread.
+ */
+class CallbackStats {
+
+public:
+    static int64_t threadCpuTimeNanos() {
+        timespec time{};
+        clock_gettime(CLOCK_THREAD_CPUTIME_ID, &time);
+        return static_cast<int64_t>(time.tv_sec) * 1000000000 + time.tv_nsec;
+    }
+
+    void reset() {
+        mCallbackCount.store(0, std::memory_order_relaxed);
+        mCpuTimeNanos.store(0, std::memory_order_relaxed);
+        mStartTimeNanos.store(steadyTimeNanos(), std::memory_order_relaxed);
+    }
+
+    void record(int64_t cpuTimeNanos) {
+        mCallbackCount.fetch_add(1, std::memory_order_relaxed);
+        mCpuTimeNanos.fetch_add(cpuTimeNanos, std::memory_order_relaxed);
+    }
+
+    int64_t getCallbackCount() const { return mCallbackCount.load(std::memory_order_relaxed); }
+
+    double getWakeupsPerSecond() const {
+        const int64_t elapsedNanos =
+                steadyTimeNanos() - mStartTimeNanos.load(std::memory_order_relaxed);
+        if (elapsedNanos <= 0) return 0;
+        return getCallbackCount() * 1e9 / elapsedNanos;
+    }
+
+    double getAverageCpuTimeMicros() const {
+        const int64_t callbackCount = getCallbackCount();
+        if (callbackCount == 0) return 0;
+        return mCpuTimeNanos.load(std::memory_order_relaxed) / 1e3 / callbackCount;
+    }
+
+private:
+    std::atomic<int64_t> mCallbackCount{0};
+    std::atomic<int64_t> mCpuTimeNanos{0};
+    std::atomic<int64_t> mStartTimeNanos{steadyTimeNanos()};
+
+    static int64_t steadyTimeNanos() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+};
+
+#endif //METRONOMEPLUS_CALLBACKSTATS_H
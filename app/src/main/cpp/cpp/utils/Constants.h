@@ -9,8 +9,13 @@ struct AudioProperties {
 };
 
 constexpr int32_t kSampleRate = 48000;
+// Channel count the beat sounds are decoded to and the Mixer buses run at. The output stream
+// opens with as many channels as the device has, see `BusRouter`.
 constexpr int kChannelCount = 2;
 
+// Power saving mode trades latency for fewer wakeups, ~85 ms per callback at 48 kHz
+constexpr int32_t kPowerSavingFramesPerCallback = 4096;
+
 //Beats
 constexpr char kNormalBeat[] {"beat_4.wav" } ;
 constexpr char kSilenceBeat[] { } ;
@@ -2,12 +2,22 @@
 #define METRONOMEPLUS_LOGGING_H
 
 #include <cstdio>
-#include <android/log.h>
 
 #define APP_NAME "MetronomePlus-C"
+
+#ifdef __ANDROID__
+#include <android/log.h>
+
 #define LOGD(...) ((void)__android_log_print(ANDROID_LOG_DEBUG, APP_NAME, __VA_ARGS__))
 #define LOGI(...) ((void)__android_log_print(ANDROID_LOG_INFO, APP_NAME, __VA_ARGS__))
 #define LOGW(...) ((void)__android_log_print(ANDROID_LOG_WARN, APP_NAME, __VA_ARGS__))
 #define LOGE(...) ((void)__android_log_print(ANDROID_LOG_ERROR, APP_NAME, __VA_ARGS__))
+#else
+// Host builds (tests, benchmarks, tools) log warnings and errors to stderr
+#define LOGD(...) ((void)0)
+#define LOGI(...) ((void)0)
+#define LOGW(...) ((void)(fprintf(stderr, APP_NAME " W: " __VA_ARGS__), fputc('\n', stderr)))
+#define LOGE(...) ((void)(fprintf(stderr, APP_NAME " E: " __VA_ARGS__), fputc('\n', stderr)))
+#endif
 
 #endif //METRONOMEPLUS_LOGGING_H
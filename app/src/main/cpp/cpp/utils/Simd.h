@@ -0,0 +1,210 @@
+#ifndef METRONOMEPLUS_SIMD_H
+#define METRONOMEPLUS_SIMD_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define METRONOMEPLUS_NEON 1
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define METRONOMEPLUS_SSE2 1
+#endif
+
+/**
+ * Small vectorized kernels for the audio callbacks. Each has a NEON path (armeabi-v7a, arm64-v8a),
+ * an SSE2 path (x86, x86_64) and a scalar fallback, which also handles the tail of every buffer.
+ *
+ * `float4` and `uint4` wrap the four lane registers of each instruction set so kernels that keep
+ * per-lane state (oscillators, envelopes, noise) can be written once.
+ */
+
+#if METRONOMEPLUS_NEON
+using float4 = float32x4_t;
+using uint4 = uint32x4_t;
+
+inline float4 load4(const float *data) { return vld1q_f32(data); }
+inline void store4(float *data, float4 value) { vst1q_f32(data, value); }
+inline float4 splat4(float value) { return vdupq_n_f32(value); }
+inline float4 add4(float4 a, float4 b) { return vaddq_f32(a, b); }
+inline float4 sub4(float4 a, float4 b) { return vsubq_f32(a, b); }
+inline float4 mul4(float4 a, float4 b) { return vmulq_f32(a, b); }
+inline float4 max4(float4 a, float4 b) { return vmaxq_f32(a, b); }
+inline float4 min4(float4 a, float4 b) { return vminq_f32(a, b); }
+inline float4 abs4(float4 a) { return vabsq_f32(a); }
+inline float4 div4(float4 a, float4 b) {
+#if defined(__aarch64__)
+    return vdivq_f32(a, b);
+#else
+    // armeabi-v7a has no vector divide, refine the reciprocal estimate twice instead
+    float32x4_t reciprocal = vrecpeq_f32(b);
+    reciprocal = vmulq_f32(vrecpsq_f32(b, reciprocal), reciprocal);
+    reciprocal = vmulq_f32(vrecpsq_f32(b, reciprocal), reciprocal);
+    return vmulq_f32(a, reciprocal);
+#endif
+}
+// Magnitude of `magnitude` with the sign of `sign`
+inline float4 copySign4(float4 magnitude, float4 sign) {
+    return vbslq_f32(vdupq_n_u32(0x80000000u), sign, magnitude);
+}
+// Swaps the lanes of each pair, (a, b, c, d) becomes (b, a, d, c)
+inline float4 swapPairs4(float4 a) { return vrev64q_f32(a); }
+
+inline uint4 loadu4(const uint32_t *data) { return vld1q_u32(data); }
+inline void storeu4(uint32_t *data, uint4 value) { vst1q_u32(data, value); }
+inline uint4 xor4(uint4 a, uint4 b) { return veorq_u32(a, b); }
+template<int Bits> inline uint4 shiftLeft4(uint4 a) { return vshlq_n_u32(a, Bits); }
+template<int Bits> inline uint4 shiftRight4(uint4 a) { return vshrq_n_u32(a, Bits); }
+// Reads the bits as signed integers, so the result spans [-2^31, 2^31)
+inline float4 toFloat4(uint4 a) { return vcvtq_f32_s32(vreinterpretq_s32_u32(a)); }
+#elif METRONOMEPLUS_SSE2
+using float4 = __m128;
+using uint4 = __m128i;
+
+inline float4 load4(const float *data) { return _mm_loadu_ps(data); }
+inline void store4(float *data, float4 value) { _mm_storeu_ps(data, value); }
+inline float4 splat4(float value) { return _mm_set1_ps(value); }
+inline float4 add4(float4 a, float4 b) { return _mm_add_ps(a, b); }
+inline float4 sub4(float4 a, float4 b) { return _mm_sub_ps(a, b); }
+inline float4 mul4(float4 a, float4 b) { return _mm_mul_ps(a, b); }
+inline float4 max4(float4 a, float4 b) { return _mm_max_ps(a, b); }
+inline float4 min4(float4 a, float4 b) { return _mm_min_ps(a, b); }
+inline float4 abs4(float4 a) { return _mm_andnot_ps(_mm_set1_ps(-0.0f), a); }
+inline float4 div4(float4 a, float4 b) { return _mm_div_ps(a, b); }
+inline float4 copySign4(float4 magnitude, float4 sign) {
+    const __m128 signMask = _mm_set1_ps(-0.0f);
+    return _mm_or_ps(_mm_andnot_ps(signMask, magnitude), _mm_and_ps(signMask, sign));
+}
+inline float4 swapPairs4(float4 a) { return _mm_shuffle_ps(a, a, _MM_SHUFFLE(2, 3, 0, 1)); }
+
+inline uint4 loadu4(const uint32_t *data) {
+    return _mm_loadu_si128(reinterpret_cast<const __m128i *>(data));
+}
+inline void storeu4(uint32_t *data, uint4 value) {
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(data), value);
+}
+inline uint4 xor4(uint4 a, uint4 b) { return _mm_xor_si128(a, b); }
+template<int Bits> inline uint4 shiftLeft4(uint4 a) { return _mm_slli_epi32(a, Bits); }
+template<int Bits> inline uint4 shiftRight4(uint4 a) { return _mm_srli_epi32(a, Bits); }
+inline float4 toFloat4(uint4 a) { return _mm_cvtepi32_ps(a); }
+#else
+struct float4 { float lanes[4]; };
+struct uint4 { uint32_t lanes[4]; };
+
+template<typename Operation>
+inline float4 map4(float4 a, float4 b, Operation operation) {
+    float4 result;
+    for (int i = 0; i < 4; ++i) result.lanes[i] = operation(a.lanes[i], b.lanes[i]);
+    return result;
+}
+
+inline float4 load4(const float *data) { return {{data[0], data[1], data[2], data[3]}}; }
+inline void store4(float *data, float4 value) {
+    for (int i = 0; i < 4; ++i) data[i] = value.lanes[i];
+}
+inline float4 splat4(float value) { return {{value, value, value, value}}; }
+inline float4 add4(float4 a, float4 b) {
+    return map4(a, b, [](float x, float y) { return x + y; });
+}
+inline float4 sub4(float4 a, float4 b) {
+    return map4(a, b, [](float x, float y) { return x - y; });
+}
+inline float4 mul4(float4 a, float4 b) {
+    return map4(a, b, [](float x, float y) { return x * y; });
+}
+inline float4 max4(float4 a, float4 b) {
+    return map4(a, b, [](float x, float y) { return x > y ? x : y; });
+}
+inline float4 min4(float4 a, float4 b) {
+    return map4(a, b, [](float x, float y) { return x < y ? x : y; });
+}
+inline float4 abs4(float4 a) {
+    return map4(a, a, [](float x, float) { return x < 0 ? -x : x; });
+}
+inline float4 div4(float4 a, float4 b) {
+    return map4(a, b, [](float x, float y) { return x / y; });
+}
+inline float4 copySign4(float4 magnitude, float4 sign) {
+    return map4(magnitude, sign, [](float x, float y) { return std::copysign(x, y); });
+}
+inline float4 swapPairs4(float4 a) {
+    return {{a.lanes[1], a.lanes[0], a.lanes[3], a.lanes[2]}};
+}
+
+inline uint4 loadu4(const uint32_t *data) { return {{data[0], data[1], data[2], data[3]}}; }
+inline void storeu4(uint32_t *data, uint4 value) {
+    for (int i = 0; i < 4; ++i) data[i] = value.lanes[i];
+}
+inline uint4 xor4(uint4 a, uint4 b) {
+    return {{a.lanes[0] ^ b.lanes[0], a.lanes[1] ^ b.lanes[1],
+             a.lanes[2] ^ b.lanes[2], a.lanes[3] ^ b.lanes[3]}};
+}
+template<int Bits> inline uint4 shiftLeft4(uint4 a) {
+    for (int i = 0; i < 4; ++i) a.lanes[i] <<= Bits;
+    return a;
+}
+template<int Bits> inline uint4 shiftRight4(uint4 a) {
+    for (int i = 0; i < 4; ++i) a.lanes[i] >>= Bits;
+    return a;
+}
+inline float4 toFloat4(uint4 a) {
+    float4 result;
+    for (int i = 0; i < 4; ++i) {
+        result.lanes[i] = static_cast<float>(static_cast<int32_t>(a.lanes[i]));
+    }
+    return result;
+}
+#endif
+
+inline float sumOfSquares(const float *data, int32_t numSamples) {
+    int32_t i = 0;
+    float sum = 0;
+
+#if METRONOMEPLUS_NEON
+    float32x4_t accumulator = vdupq_n_f32(0);
+    for (; i + 4 <= numSamples; i += 4) {
+        float32x4_t samples = vld1q_f32(&data[i]);
+        accumulator = vmlaq_f32(accumulator, samples, samples);
+    }
+    float32x2_t pair = vadd_f32(vget_low_f32(accumulator), vget_high_f32(accumulator));
+    sum = vget_lane_f32(vpadd_f32(pair, pair), 0);
+#elif METRONOMEPLUS_SSE2
+    __m128 accumulator = _mm_setzero_ps();
+    for (; i + 4 <= numSamples; i += 4) {
+        __m128 samples = _mm_loadu_ps(&data[i]);
+        accumulator = _mm_add_ps(accumulator, _mm_mul_ps(samples, samples));
+    }
+    float lanes[4];
+    _mm_storeu_ps(lanes, accumulator);
+    sum = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+#endif
+
+    for (; i < numSamples; ++i) {
+        sum += data[i] * data[i];
+    }
+    return sum;
+}
+
+inline float peakAbs(const float *data, int32_t numSamples) {
+    int32_t i = 0;
+    float peak = 0;
+
+    if (numSamples >= 4) {
+        float4 peaks = abs4(load4(data));
+        for (i = 4; i + 4 <= numSamples; i += 4) {
+            peaks = max4(peaks, abs4(load4(&data[i])));
+        }
+        float lanes[4];
+        store4(lanes, peaks);
+        peak = std::max(std::max(lanes[0], lanes[1]), std::max(lanes[2], lanes[3]));
+    }
+
+    for (; i < numSamples; ++i) {
+        peak = std::max(peak, std::abs(data[i]));
+    }
+    return peak;
+}
+
+#endif //METRONOMEPLUS_SIMD_H
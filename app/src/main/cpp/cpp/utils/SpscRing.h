@@ -0,0 +1,43 @@
+#ifndef METRONOMEPLUS_SPSCRING_H
+#define METRONOMEPLUS_SPSCRING_H
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * Lock-free ring buffer for one producer thread and one consumer thread, e.g. to hand results from
+ * the audio callback to the UI. Neither side ever blocks; `push` fails when the ring is full.
+ */
+template<typename T, uint32_t Capacity>
+class SpscRing {
+    static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0,
+                  "Capacity must be a power of two");
+
+public:
+    bool push(const T &value) {
+        const uint32_t writeIndex = mWriteIndex.load(std::memory_order_relaxed);
+        if (writeIndex - mReadIndex.load(std::memory_order_acquire) == Capacity) return false;
+
+        mItems[writeIndex & (Capacity - 1)] = value;
+        mWriteIndex.store(writeIndex + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool pop(T *value) {
+        const uint32_t readIndex = mReadIndex.load(std::memory_order_relaxed);
+        if (readIndex == mWriteIndex.load(std::memory_order_acquire)) return false;
+
+        *value = mItems[readIndex & (Capacity - 1)];
+        mReadIndex.store(readIndex + 1, std::memory_order_release);
+        return true;
+    }
+
+private:
+    std::array<T, Capacity> mItems{};
+    std::atomic<uint32_t> mWriteIndex{0};
+    std::atomic<uint32_t> mReadIndex{0};
+};
+
+#endif //METRONOMEPLUS_SPSCRING_H
@@ -0,0 +1,27 @@
+#ifndef METRONOMEPLUS_STARTUPMETRICS_H
+#define METRONOMEPLUS_STARTUPMETRICS_H
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+
+constexpr int kStartupDecodeCount = 3;
+
+/**
+ * Wall-clock duration of each engine startup phase, in microseconds. Every phase is measured from
+ * the moment `Metronome::init` was called, except the decode and stream open entries which hold
+ * the duration of the phase itself. A value of -1 means the phase has not completed (yet).
+ */
+struct StartupMetrics {
+    int64_t streamOpenUs{-1};
+    std::array<int64_t, kStartupDecodeCount> decodeUs{{-1, -1, -1}};
+    int64_t readyUs{-1};
+    int64_t firstCallbackUs{-1};
+};
+
+inline int64_t elapsedMicros(std::chrono::steady_clock::time_point since) {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - since).count();
+}
+
+#endif //METRONOMEPLUS_STARTUPMETRICS_H
@@ -0,0 +1,77 @@
+#ifndef METRONOMEPLUS_WORKERPOOL_H
+#define METRONOMEPLUS_WORKERPOOL_H
+
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+/**
+ * A small fixed-size pool of worker threads used to run blocking setup work (opening streams,
+ * decoding assets) concurrently. Tasks are run in submission order; the destructor finishes any
+ * queued tasks before joining the workers.
+ */
+class WorkerPool {
+
+public:
+    explicit WorkerPool(size_t threadCount) {
+        for (size_t i = 0; i < threadCount; ++i) {
+            mWorkers.emplace_back([this] { workerLoop(); });
+        }
+    }
+
+    ~WorkerPool() {
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mIsStopping = true;
+        }
+        mCondition.notify_all();
+        for (auto &worker : mWorkers) {
+            if (worker.joinable()) worker.join();
+        }
+    }
+
+    WorkerPool(const WorkerPool &) = delete;
+    WorkerPool &operator=(const WorkerPool &) = delete;
+
+    template<typename Function>
+    std::future<typename std::result_of<Function()>::type> submit(Function function) {
+        using Result = typename std::result_of<Function()>::type;
+
+        auto task = std::make_shared<std::packaged_task<Result()>>(std::move(function));
+        std::future<Result> result = task->get_future();
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mTasks.emplace([task] { (*task)(); });
+        }
+        mCondition.notify_one();
+        return result;
+    }
+
+private:
+    std::vector<std::thread> mWorkers;
+    std::queue<std::function<void()>> mTasks;
+    std::mutex mMutex;
+    std::condition_variable mCondition;
+    bool mIsStopping{false};
+
+    void workerLoop() {
+        while (true) {
+            std::function<void()> task;
+            {
+                std::unique_lock<std::mutex> lock(mMutex);
+                mCondition.wait(lock, [this] { return mIsStopping || !mTasks.empty(); });
+                if (mTasks.empty()) return;
+                task = std::move(mTasks.front());
+                mTasks.pop();
+            }
+            task();
+        }
+    }
+};
+
+#endif //METRONOMEPLUS_WORKERPOOL_H
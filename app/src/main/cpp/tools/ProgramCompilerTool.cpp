@@ -0,0 +1,76 @@
+// Host tool that compiles practice programs (setlists) to the binary format loaded by the engine,
+// and validates compiled files.
+//
+//   metronomeplus-programc <source.txt> <output.mpp>
+//   metronomeplus-programc --validate <program.mpp>
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "program/Program.h"
+#include "program/ProgramCompiler.h"
+
+namespace {
+
+int usage() {
+    fprintf(stderr, "usage: metronomeplus-programc <source> <output>\n"
+                    "       metronomeplus-programc --validate <program>\n");
+    return 2;
+}
+
+int validate(const char *path) {
+    std::unique_ptr<Program> program = Program::fromFile(path);
+    if (!program) {
+        fprintf(stderr, "%s: invalid program\n", path);
+        return 1;
+    }
+
+    printf("%s: %d songs\n", path, program->getSongCount());
+    for (int32_t i = 0; i < program->getSongCount(); ++i) {
+        const SongTimeline *song = program->getSong(i);
+        printf("  %3d  %-32s %u bars\n", i, program->getSongName(i).c_str(), song->barCount);
+    }
+    return 0;
+}
+
+int compile(const char *sourcePath, const char *outputPath) {
+    std::ifstream sourceFile(sourcePath);
+    if (!sourceFile) {
+        fprintf(stderr, "%s: cannot read\n", sourcePath);
+        return 1;
+    }
+    std::stringstream source;
+    source << sourceFile.rdbuf();
+
+    std::vector<uint8_t> compiled;
+    std::string error;
+    if (!ProgramCompiler::compile(source.str(), &compiled, &error)) {
+        fprintf(stderr, "%s: %s\n", sourcePath, error.c_str());
+        return 1;
+    }
+
+    std::ofstream output(outputPath, std::ios::binary);
+    output.write(reinterpret_cast<const char *>(compiled.data()),
+                 static_cast<std::streamsize>(compiled.size()));
+    if (!output) {
+        fprintf(stderr, "%s: cannot write\n", outputPath);
+        return 1;
+    }
+    return 0;
+}
+
+}
+
+int main(int argc, char **argv) {
+    if (argc != 3) return usage();
+
+    if (strcmp(argv[1], "--validate") == 0) {
+        return validate(argv[2]);
+    }
+    return compile(argv[1], argv[2]);
+}
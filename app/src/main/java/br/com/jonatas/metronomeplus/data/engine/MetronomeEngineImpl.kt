@@ -5,39 +5,77 @@ import br.com.jonatas.metronomeplus.data.model.BeatDto
 import br.com.jonatas.metronomeplus.data.model.MeasureDto
 import br.com.jonatas.metronomeplus.domain.engine.BeatChangeListener
 import br.com.jonatas.metronomeplus.domain.engine.MetronomeEngine
+import br.com.jonatas.metronomeplus.domain.engine.OutputBus
 import br.com.jonatas.metronomeplus.domain.provider.AssetProvider
 import br.com.jonatas.metronomeplus.domain.provider.AudioSettingsProvider
+import br.com.jonatas.metronomeplus.domain.provider.ScreenStateProvider
 
 class MetronomeEngineImpl(
     private val assetProvider: AssetProvider,
-    private val audioSettingsProvider: AudioSettingsProvider
+    private val audioSettingsProvider: AudioSettingsProvider,
+    private val screenStateProvider: ScreenStateProvider
 ) : MetronomeEngine {
 
     override fun initialize(measureDto: MeasureDto) {
-        native_onInit(assetManager = assetProvider.getAssets())
         native_setDefaultStreamValues(
             defaultSampleRate = audioSettingsProvider.getSampleRate(),
             defaultFramesPerBurst = audioSettingsProvider.getFramesPerBurst()
         )
+        native_onInit(
+            assetManager = assetProvider.getAssets(),
+            outputChannelCount = audioSettingsProvider.getOutputChannelCount()
+        )
 
         native_SetBPM(measureDto.bpm)
         native_SetBeats(measureDto.beats.toTypedArray())
+
+        // Large buffers while nobody is looking at the screen, low latency otherwise
+        screenStateProvider.setOnScreenStateChangeListener { isScreenOn ->
+            native_setPowerSavingMode(isPowerSaving = !isScreenOn)
+        }
+    }
+
+    override fun cleanup() {
+        screenStateProvider.removeOnScreenStateChangeListener()
+        native_onEnd()
     }
 
-    override fun cleanup() = native_onEnd()
     override fun setBpm(bpm: Int) = native_SetBPM(bpm)
     override fun setBeats(beats: Array<BeatDto>) = native_SetBeats(beats)
     override fun startPlaying() = native_onStartPlaying()
     override fun stopPlaying() = native_onStopPlaying()
+    override fun loadProgram(path: String): Int = native_LoadProgram(path)
+    override fun selectSong(index: Int): Boolean = native_SelectSong(index)
+    override fun setTimingAnalysisEnabled(isEnabled: Boolean): Boolean =
+        native_setTimingAnalysisEnabled(isEnabled)
+    override fun setLatencyCompensationMs(compensationMs: Int) =
+        native_setLatencyCompensationMs(compensationMs)
+    override fun drainTimingDeviations(): FloatArray = native_drainTimingDeviations()
+    override fun getGainReductionDb(): Float = native_getGainReductionDb()
+    override fun setSynthesizedClicks(isSynthesized: Boolean) =
+        native_setSynthesizedClicks(isSynthesized)
+    override fun setBusRoute(bus: OutputBus, leftChannel: Int, rightChannel: Int, gain: Float) =
+        native_setBusRoute(bus.ordinal, leftChannel, rightChannel, gain)
+    override fun getOutputChannelCount(): Int = native_getOutputChannelCount()
     override fun setOnBeatChangeListener(onBeatChangeListener: BeatChangeListener) =
         native_setOnBeatChangeListener(onBeatChangeListener = onBeatChangeListener)
 
-    private external fun native_onInit(assetManager: AssetManager)
+    private external fun native_onInit(assetManager: AssetManager, outputChannelCount: Int)
     private external fun native_onEnd()
     private external fun native_SetBPM(bpm: Int)
     private external fun native_SetBeats(beats: Array<BeatDto>)
     private external fun native_onStartPlaying()
     private external fun native_onStopPlaying()
+    private external fun native_LoadProgram(path: String): Int
+    private external fun native_SelectSong(songIndex: Int): Boolean
+    private external fun native_setPowerSavingMode(isPowerSaving: Boolean)
+    private external fun native_setTimingAnalysisEnabled(isEnabled: Boolean): Boolean
+    private external fun native_setLatencyCompensationMs(compensationMs: Int)
+    private external fun native_drainTimingDeviations(): FloatArray
+    private external fun native_getGainReductionDb(): Float
+    private external fun native_setSynthesizedClicks(isSynthesized: Boolean)
+    private external fun native_setBusRoute(bus: Int, leftChannel: Int, rightChannel: Int, gain: Float)
+    private external fun native_getOutputChannelCount(): Int
     private external fun native_setDefaultStreamValues(
         defaultSampleRate: Int,
         defaultFramesPerBurst: Int
@@ -2,6 +2,7 @@ package br.com.jonatas.metronomeplus.data.provider
 
 import android.content.Context
 import android.content.Context.AUDIO_SERVICE
+import android.media.AudioDeviceInfo
 import android.media.AudioManager
 import br.com.jonatas.metronomeplus.domain.provider.AudioSettingsProvider
 
@@ -15,4 +16,19 @@ class AudioSettingProviderImpl(private val context: Context) : AudioSettingsProv
     override fun getFramesPerBurst(): Int {
         return myAudioMgr.getProperty(AudioManager.PROPERTY_OUTPUT_FRAMES_PER_BUFFER).toInt()
     }
+
+    // Audio is routed to a USB interface while one is attached, so open all of its outputs
+    override fun getOutputChannelCount(): Int {
+        return myAudioMgr.getDevices(AudioManager.GET_DEVICES_OUTPUTS)
+            .filter {
+                it.type == AudioDeviceInfo.TYPE_USB_DEVICE ||
+                    it.type == AudioDeviceInfo.TYPE_USB_HEADSET
+            }
+            .flatMap { it.channelCounts.asList() }
+            .maxOrNull() ?: STEREO_CHANNEL_COUNT
+    }
+
+    companion object {
+        private const val STEREO_CHANNEL_COUNT = 2
+    }
 }
@@ -0,0 +1,35 @@
+package br.com.jonatas.metronomeplus.data.provider
+
+import android.content.BroadcastReceiver
+import android.content.Context
+import android.content.Intent
+import android.content.IntentFilter
+import br.com.jonatas.metronomeplus.domain.provider.ScreenStateProvider
+
+class ScreenStateProviderImpl(private val context: Context) : ScreenStateProvider {
+    private var screenStateReceiver: BroadcastReceiver? = null
+
+    override fun setOnScreenStateChangeListener(onScreenStateChange: (isScreenOn: Boolean) -> Unit) {
+        removeOnScreenStateChangeListener()
+
+        val receiver = object : BroadcastReceiver() {
+            override fun onReceive(context: Context, intent: Intent) {
+                when (intent.action) {
+                    Intent.ACTION_SCREEN_ON -> onScreenStateChange(true)
+                    Intent.ACTION_SCREEN_OFF -> onScreenStateChange(false)
+                }
+            }
+        }
+        val filter = IntentFilter().apply {
+            addAction(Intent.ACTION_SCREEN_ON)
+            addAction(Intent.ACTION_SCREEN_OFF)
+        }
+        context.registerReceiver(receiver, filter)
+        screenStateReceiver = receiver
+    }
+
+    override fun removeOnScreenStateChangeListener() {
+        screenStateReceiver?.let { context.unregisterReceiver(it) }
+        screenStateReceiver = null
+    }
+}
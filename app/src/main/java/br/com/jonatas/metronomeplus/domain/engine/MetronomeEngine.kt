@@ -9,6 +9,15 @@ interface MetronomeEngine {
     fun setBeats(beats: Array<BeatDto>)
     fun startPlaying()
     fun stopPlaying()
+    fun loadProgram(path: String): Int
+    fun selectSong(index: Int): Boolean
+    fun setTimingAnalysisEnabled(isEnabled: Boolean): Boolean
+    fun setLatencyCompensationMs(compensationMs: Int)
+    fun drainTimingDeviations(): FloatArray
+    fun getGainReductionDb(): Float
+    fun setSynthesizedClicks(isSynthesized: Boolean)
+    fun setBusRoute(bus: OutputBus, leftChannel: Int, rightChannel: Int, gain: Float)
+    fun getOutputChannelCount(): Int
     fun cleanup()
     fun setOnBeatChangeListener(onBeatChangeListener: BeatChangeListener)
 }
\ No newline at end of file
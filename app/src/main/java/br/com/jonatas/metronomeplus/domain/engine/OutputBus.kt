@@ -0,0 +1,12 @@
+package br.com.jonatas.metronomeplus.domain.engine
+
+/**
+ * Submixes of the engine that can each be routed to their own output channels. The order
+ * matches `Bus` in the native engine.
+ */
+enum class OutputBus {
+    CLICK,
+    ACCENT,
+    /** The count-in bars of a song */
+    CUE
+}
@@ -3,4 +3,5 @@ package br.com.jonatas.metronomeplus.domain.provider
 interface AudioSettingsProvider {
     fun getSampleRate(): Int
     fun getFramesPerBurst(): Int
+    fun getOutputChannelCount(): Int
 }
\ No newline at end of file
@@ -0,0 +1,6 @@
+package br.com.jonatas.metronomeplus.domain.provider
+
+interface ScreenStateProvider {
+    fun setOnScreenStateChangeListener(onScreenStateChange: (isScreenOn: Boolean) -> Unit)
+    fun removeOnScreenStateChangeListener()
+}
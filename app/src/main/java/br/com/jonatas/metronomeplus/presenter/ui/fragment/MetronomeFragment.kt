@@ -13,6 +13,7 @@ import androidx.lifecycle.repeatOnLifecycle
 import br.com.jonatas.metronomeplus.data.engine.MetronomeEngineImpl
 import br.com.jonatas.metronomeplus.data.provider.AssetProviderImpl
 import br.com.jonatas.metronomeplus.data.provider.AudioSettingProviderImpl
+import br.com.jonatas.metronomeplus.data.provider.ScreenStateProviderImpl
 import br.com.jonatas.metronomeplus.data.repository.MeasureRepositoryImpl
 import br.com.jonatas.metronomeplus.data.source.MeasureDataSourceImpl
 import br.com.jonatas.metronomeplus.databinding.FragmentMetronomeBinding
@@ -100,7 +101,9 @@ class MetronomeFragment : Fragment() {
     private fun setupViewModel() {
         val assetProvider = AssetProviderImpl(requireContext().applicationContext)
         val audioSettingsProvider = AudioSettingProviderImpl(requireContext().applicationContext)
-        val metronomeEngine = MetronomeEngineImpl(assetProvider, audioSettingsProvider)
+        val screenStateProvider = ScreenStateProviderImpl(requireContext().applicationContext)
+        val metronomeEngine =
+            MetronomeEngineImpl(assetProvider, audioSettingsProvider, screenStateProvider)
         val measureRepositoryImpl = MeasureRepositoryImpl(MeasureDataSourceImpl())
         val getMeasureUseCase = GetMeasureUseCaseImpl(measureRepositoryImpl)
         val increaseBpmUseCase = IncreaseBpmUseCaseImpl()
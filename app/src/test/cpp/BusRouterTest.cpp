@@ -0,0 +1,237 @@
+#include <memory>
+#include <random>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "HostAudio.h"
+#include "audio/BusRouter.h"
+#include "audio/Mixer.h"
+#include "audio/Player.h"
+
+namespace {
+
+constexpr int32_t kMaxTestedChannels = 8;
+// Odd so the vector kernels always leave a tail
+constexpr int32_t kTestFrames = 37;
+
+struct Route {
+    int32_t leftChannel;
+    int32_t rightChannel;
+    float gain;
+};
+
+std::vector<float> randomBus(int32_t numFrames, uint32_t seed) {
+    std::mt19937 random(seed);
+    std::uniform_real_distribution<float> sample(-1, 1);
+    std::vector<float> bus(static_cast<size_t>(numFrames * kBusChannelCount));
+    for (float &value : bus) value = sample(random);
+    return bus;
+}
+
+// Straightforward per sample version of the routing rules
+std::vector<float> routeByHand(const std::vector<float> &bus, int32_t channelCount, Route route) {
+    const int32_t numFrames = static_cast<int32_t>(bus.size()) / kBusChannelCount;
+    std::vector<float> output(static_cast<size_t>(numFrames * channelCount), 0.0f);
+
+    int32_t channels[kBusChannelCount]{route.leftChannel, route.rightChannel};
+    for (int32_t &channel : channels) {
+        if (channelCount == 1 && channel >= 0) channel = 0;
+        if (channel >= channelCount) channel = kUnrouted;
+    }
+    const float gain = channels[0] == channels[1] ? route.gain / 2 : route.gain;
+
+    for (int32_t frame = 0; frame < numFrames; ++frame) {
+        for (int32_t side = 0; side < kBusChannelCount; ++side) {
+            if (channels[side] == kUnrouted) continue;
+            output[frame * channelCount + channels[side]] +=
+                    gain * bus[frame * kBusChannelCount + side];
+        }
+    }
+    return output;
+}
+
+std::vector<float> route(BusRouter &router, Bus bus, const std::vector<float> &busData,
+                         int32_t channelCount) {
+    const int32_t numFrames = static_cast<int32_t>(busData.size()) / kBusChannelCount;
+    std::vector<float> output(static_cast<size_t>(numFrames * channelCount), 0.0f);
+    router.update();
+    router.apply(bus, busData.data(), output.data(), numFrames);
+    return output;
+}
+
+void expectSamplesNear(const std::vector<float> &expected, const std::vector<float> &actual,
+                       int32_t channelCount) {
+    ASSERT_EQ(expected.size(), actual.size());
+    for (size_t i = 0; i < expected.size(); ++i) {
+        ASSERT_NEAR(expected[i], actual[i], 1e-6f)
+                << "frame " << i / channelCount << " channel " << i % channelCount;
+    }
+}
+
+std::shared_ptr<DataSource> constantSource(float left, float right, int32_t numFrames) {
+    std::vector<float> samples(static_cast<size_t>(numFrames * kChannelCount));
+    for (int32_t i = 0; i < numFrames; ++i) {
+        samples[i * kChannelCount] = left;
+        samples[i * kChannelCount + 1] = right;
+    }
+    return std::make_shared<BufferDataSource>(samples,
+                                              AudioProperties{kChannelCount, kSampleRate});
+}
+
+}
+
+TEST(BusRouterTest, defaultRouteUsesTheFirstTwoOutputs) {
+    const std::vector<float> bus = randomBus(kTestFrames, 1);
+
+    for (int32_t channelCount = 1; channelCount <= kMaxTestedChannels; ++channelCount) {
+        SCOPED_TRACE(channelCount);
+        BusRouter router;
+        router.setOutputChannelCount(channelCount);
+
+        const std::vector<float> output = route(router, Bus::Click, bus, channelCount);
+        for (int32_t frame = 0; frame < kTestFrames; ++frame) {
+            const float left = bus[frame * kBusChannelCount];
+            const float right = bus[frame * kBusChannelCount + 1];
+            const float *outputFrame = &output[frame * channelCount];
+            if (channelCount == 1) {
+                ASSERT_NEAR((left + right) / 2, outputFrame[0], 1e-6f);
+                continue;
+            }
+            // Unity gain on a plain copy must be exact
+            ASSERT_EQ(left, outputFrame[0]);
+            ASSERT_EQ(right, outputFrame[1]);
+            for (int32_t channel = 2; channel < channelCount; ++channel) {
+                ASSERT_EQ(0, outputFrame[channel]) << "channel " << channel;
+            }
+        }
+    }
+}
+
+TEST(BusRouterTest, routesMatchThePerSampleRules) {
+    const std::vector<float> bus = randomBus(kTestFrames, 2);
+    const Route routes[]{
+            {0, 1, 0.5f},
+            {1, 0, 1.0f},
+            {2, 3, 0.8f},
+            {3, 3, 1.0f},
+            {0, kUnrouted, 1.0f},
+            {kUnrouted, 7, 0.25f},
+            {7, 0, 0.6f},
+            {1, 6, 1.5f},
+            {5, 12, 1.0f},
+            {kUnrouted, kUnrouted, 1.0f},
+            {0, 1, 0.0f},
+    };
+
+    for (int32_t channelCount = 1; channelCount <= kMaxTestedChannels; ++channelCount) {
+        for (const Route &testRoute : routes) {
+            SCOPED_TRACE(::testing::Message() << channelCount << " channels, route "
+                         << testRoute.leftChannel << "/" << testRoute.rightChannel);
+            BusRouter router;
+            router.setOutputChannelCount(channelCount);
+            router.setRoute(Bus::Cue, testRoute.leftChannel, testRoute.rightChannel,
+                            testRoute.gain);
+
+            expectSamplesNear(routeByHand(bus, channelCount, testRoute),
+                              route(router, Bus::Cue, bus, channelCount), channelCount);
+        }
+    }
+}
+
+TEST(BusRouterTest, mixerKeepsEachBusOnItsOwnOutputs) {
+    // Longer than one mixing chunk
+    constexpr int32_t numFrames = 2500;
+    Player click(constantSource(0.25f, -0.125f, numFrames * 2));
+    Player cue(constantSource(0.5f, 0.375f, numFrames * 2));
+
+    for (int32_t channelCount = 4; channelCount <= kMaxTestedChannels; ++channelCount) {
+        SCOPED_TRACE(channelCount);
+        click.setPlaying(true);
+        cue.setPlaying(true);
+
+        Mixer mixer;
+        mixer.setChannelCount(channelCount);
+        mixer.addTrack(&click, Bus::Click);
+        mixer.addTrack(&cue, Bus::Cue);
+        mixer.setRoute(Bus::Click, 2, 3, 1.0f);
+        mixer.setRoute(Bus::Cue, 0, 1, 0.5f);
+
+        std::vector<float> output(static_cast<size_t>(numFrames * channelCount));
+        mixer.renderAudio(output.data(), numFrames);
+
+        for (int32_t frame = 0; frame < numFrames; ++frame) {
+            const float *outputFrame = &output[frame * channelCount];
+            ASSERT_EQ(0.25f, outputFrame[0]) << "frame " << frame;
+            ASSERT_EQ(0.1875f, outputFrame[1]) << "frame " << frame;
+            ASSERT_EQ(0.25f, outputFrame[2]) << "frame " << frame;
+            ASSERT_EQ(-0.125f, outputFrame[3]) << "frame " << frame;
+            for (int32_t channel = 4; channel < channelCount; ++channel) {
+                ASSERT_EQ(0, outputFrame[channel]) << "frame " << frame;
+            }
+        }
+    }
+}
+
+TEST(BusRouterTest, routeChangesApplyFromTheNextRender) {
+    constexpr int32_t numFrames = 64;
+    Player accent(constantSource(0.5f, 0.5f, numFrames * 2));
+    accent.setPlaying(true);
+
+    Mixer mixer;
+    mixer.setChannelCount(kChannelCount);
+    mixer.addTrack(&accent, Bus::Accent);
+
+    std::vector<float> output(static_cast<size_t>(numFrames * kChannelCount));
+    mixer.renderAudio(output.data(), numFrames);
+    EXPECT_EQ(0.5f, output[0]);
+    EXPECT_EQ(0.5f, output[1]);
+
+    // The accent on the left side only
+    mixer.setRoute(Bus::Accent, 0, 0, 1.0f);
+    mixer.renderAudio(output.data(), numFrames);
+    for (int32_t frame = 0; frame < numFrames; ++frame) {
+        ASSERT_EQ(0.5f, output[frame * kChannelCount]) << "frame " << frame;
+        ASSERT_EQ(0, output[frame * kChannelCount + 1]) << "frame " << frame;
+    }
+}
+
+TEST(BusRouterTest, soundsKeepPlayingWhileTheirBusIsMuted) {
+    constexpr int32_t numFrames = 64;
+    Player click(constantSource(0.5f, 0.5f, numFrames * 2));
+
+    for (const Route &mute : {Route{0, 1, 0.0f}, Route{kUnrouted, kUnrouted, 1.0f}}) {
+        SCOPED_TRACE(::testing::Message() << "route " << mute.leftChannel << "/"
+                                          << mute.rightChannel << " at " << mute.gain);
+        Mixer mixer;
+        mixer.setChannelCount(kChannelCount);
+        mixer.addTrack(&click, Bus::Click);
+        std::vector<float> output(static_cast<size_t>(numFrames * kChannelCount));
+
+        // Triggered while muted, the click runs out during the first two renders
+        mixer.setRoute(Bus::Click, mute.leftChannel, mute.rightChannel, mute.gain);
+        click.setPlaying(true);
+        mixer.renderAudio(output.data(), numFrames);
+        mixer.renderAudio(output.data(), numFrames);
+
+        // Unmuted afterwards, the stale rest of the click must not play
+        mixer.setRoute(Bus::Click, 0, 1, 1.0f);
+        mixer.renderAudio(output.data(), numFrames);
+        for (size_t i = 0; i < output.size(); ++i) {
+            ASSERT_EQ(0, output[i]) << "sample " << i;
+        }
+    }
+}
+
+TEST(BusRouterTest, routesWiderThanOnePassMatchThePerSampleRules) {
+    constexpr int32_t channelCount = 20;
+    const std::vector<float> bus = randomBus(kTestFrames, 3);
+    const Route testRoute{18, 1, 0.7f};
+
+    BusRouter router;
+    router.setOutputChannelCount(channelCount);
+    router.setRoute(Bus::Click, testRoute.leftChannel, testRoute.rightChannel, testRoute.gain);
+
+    expectSamplesNear(routeByHand(bus, channelCount, testRoute),
+                      route(router, Bus::Click, bus, channelCount), channelCount);
+}
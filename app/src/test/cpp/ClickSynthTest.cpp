@@ -0,0 +1,132 @@
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "audio/ClickSynth.h"
+#include "audio/Mixer.h"
+#include "audio/Sequencer.h"
+
+namespace {
+
+const AudioProperties kProperties{kChannelCount, kSampleRate};
+const ClickVoice kVoices[]{ClickVoice::Woodblock, ClickVoice::Beep, ClickVoice::Rim};
+const BeatState kAudibleStates[]{BeatState::Normal, BeatState::Medium, BeatState::Accent};
+
+std::vector<float> renderInBursts(ClickSynth &synth, int64_t numFrames, uint32_t seed) {
+    std::vector<float> output(static_cast<size_t>(numFrames * kChannelCount));
+    std::mt19937 random(seed);
+    std::uniform_int_distribution<int32_t> burst(1, 1024);
+
+    synth.setPlaying(true);
+    int64_t position = 0;
+    while (position < numFrames) {
+        const int32_t framesToRender = static_cast<int32_t>(
+                std::min<int64_t>(burst(random), numFrames - position));
+        synth.renderAudio(&output[position * kChannelCount], framesToRender);
+        position += framesToRender;
+    }
+    return output;
+}
+
+// Frequency of the first channel estimated from its zero crossings
+float estimateFrequency(const std::vector<float> &output, int64_t numFrames) {
+    int32_t crossings = 0;
+    for (int64_t i = 1; i < numFrames; ++i) {
+        const float previous = output[(i - 1) * kChannelCount];
+        const float current = output[i * kChannelCount];
+        if ((previous < 0) != (current < 0)) ++crossings;
+    }
+    return crossings * 0.5f * kSampleRate / numFrames;
+}
+
+}
+
+TEST(ClickSynthTest, rendersTheBakedClickInAnyBurstSize) {
+    uint32_t seed = 1;
+    for (ClickVoice voice : kVoices) {
+        for (BeatState state : kAudibleStates) {
+            ClickSynth synth(clickParameters(voice, state), kProperties);
+            std::shared_ptr<DataSource> baked = synth.bake();
+            ASSERT_EQ(synth.getLengthFrames() * kChannelCount, baked->getSize());
+
+            const std::vector<float> output =
+                    renderInBursts(synth, synth.getLengthFrames() + 1000, seed++);
+
+            for (int64_t i = 0; i < baked->getSize(); ++i) {
+                ASSERT_EQ(baked->getData()[i], output[i]) << "sample " << i;
+            }
+            for (size_t i = baked->getSize(); i < output.size(); ++i) {
+                ASSERT_EQ(0, output[i]) << "sample " << i;
+            }
+        }
+    }
+}
+
+TEST(ClickSynthTest, clicksStayInRangeAndDecay) {
+    for (ClickVoice voice : kVoices) {
+        for (BeatState state : kAudibleStates) {
+            const ClickParameters parameters = clickParameters(voice, state);
+            std::shared_ptr<DataSource> baked = ClickSynth(parameters, kProperties).bake();
+
+            float peak = 0;
+            for (int64_t i = 0; i < baked->getSize(); ++i) {
+                peak = std::max(peak, std::abs(baked->getData()[i]));
+            }
+            EXPECT_GT(peak, parameters.gain * 0.5f);
+            EXPECT_LE(peak, parameters.gain * 1.001f);
+
+            // The last frames are 80 dB down, so cutting the click there is inaudible
+            const int64_t tailStart = baked->getSize() - 16 * kChannelCount;
+            for (int64_t i = tailStart; i < baked->getSize(); ++i) {
+                EXPECT_LE(std::abs(baked->getData()[i]), parameters.gain * 2e-4f);
+            }
+        }
+    }
+}
+
+TEST(ClickSynthTest, strongerBeatsArePitchedHigher) {
+    // 20 ms of the beep, which has no noise so its pitch can be read from the zero crossings
+    const int64_t numFrames = kSampleRate / 50;
+    float previousFrequency = 0;
+
+    for (BeatState state : kAudibleStates) {
+        const ClickParameters parameters = clickParameters(ClickVoice::Beep, state);
+        ClickSynth synth(parameters, kProperties);
+        const float frequency = estimateFrequency(renderInBursts(synth, numFrames, 3), numFrames);
+
+        EXPECT_NEAR(parameters.frequencyHz, frequency, parameters.frequencyHz * 0.05f);
+        EXPECT_GT(frequency, previousFrequency);
+        previousFrequency = frequency;
+    }
+}
+
+TEST(ClickSynthTest, sequencerTriggersSynthesizedClicksOnTheGrid) {
+    Mixer mixer;
+    mixer.setChannelCount(kChannelCount);
+    Sequencer sequencer(mixer, kSampleRate);
+
+    ClickSynth normal(clickParameters(ClickVoice::Woodblock, BeatState::Normal), kProperties);
+    ClickSynth accent(clickParameters(ClickVoice::Woodblock, BeatState::Accent), kProperties);
+    mixer.addTrack(&normal);
+    mixer.addTrack(&accent);
+    sequencer.setPlayer(BeatState::Normal, &normal);
+    sequencer.setPlayer(BeatState::Accent, &accent);
+
+    sequencer.setBPM(120);
+    sequencer.setBeats({{BeatState::Accent}, {BeatState::Normal}});
+    sequencer.start();
+
+    const int32_t framesPerBeat = kSampleRate / 2;
+    std::vector<float> output(static_cast<size_t>(framesPerBeat) * 4 * kChannelCount);
+    for (size_t position = 0; position < output.size(); position += 192 * kChannelCount) {
+        sequencer.renderAudio(&output[position], 192);
+    }
+
+    for (int32_t beat = 1; beat < 4; ++beat) {
+        const size_t onset = static_cast<size_t>(beat) * framesPerBeat * kChannelCount;
+        EXPECT_EQ(0, output[onset - kChannelCount]) << "beat " << beat;
+        EXPECT_NE(0, output[onset]) << "beat " << beat;
+    }
+}
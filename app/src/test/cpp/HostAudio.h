@@ -0,0 +1,72 @@
+#ifndef METRONOMEPLUS_HOSTAUDIO_H
+#define METRONOMEPLUS_HOSTAUDIO_H
+
+#include <cstdint>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "audio/DataSource.h"
+#include "audio/Pcm16DataSource.h"
+#include "audio/WavDecoder.h"
+#include "utils/Constants.h"
+
+/**
+ * Helpers shared by the host benchmarks and tests.
+ */
+
+class BufferDataSource : public DataSource {
+
+public:
+    BufferDataSource(std::vector<float> samples, AudioProperties properties)
+        : mSamples(std::move(samples))
+        , mProperties(properties) {
+    }
+
+    int64_t getSize() const override { return static_cast<int64_t>(mSamples.size()); }
+    AudioProperties getProperties() const override { return mProperties; }
+    const float* getData() const override { return mSamples.data(); }
+
+private:
+    const std::vector<float> mSamples;
+    const AudioProperties mProperties;
+};
+
+// Every beat sound shipped in the app's assets
+const char *const kBundledBeats[]{
+        "beat_1.wav", "beat_2.wav", "beat_3.wav", "beat_4.wav", "beat_5.wav", "beat_6.wav",
+        "beat_7.wav", "beat_8.wav", "beat_9.wav", "beat_10.wav", "beat_11.wav"
+};
+
+inline std::vector<uint8_t> readAssetFile(const std::string &filename) {
+    std::ifstream file(std::string(METRONOMEPLUS_ASSETS_DIR) + "/" + filename, std::ios::binary);
+    return std::vector<uint8_t>(std::istreambuf_iterator<char>(file),
+                                std::istreambuf_iterator<char>());
+}
+
+inline std::shared_ptr<BufferDataSource> loadAsset(const std::string &filename) {
+    const AudioProperties properties{kChannelCount, kSampleRate};
+    std::vector<uint8_t> file = readAssetFile(filename);
+
+    std::unique_ptr<float[]> decoded;
+    const int64_t numSamples = WavDecoder::decode(file.data(), file.size(), properties, decoded);
+    if (numSamples == 0) return nullptr;
+
+    return std::make_shared<BufferDataSource>(
+            std::vector<float>(decoded.get(), decoded.get() + numSamples), properties);
+}
+
+inline std::shared_ptr<Pcm16DataSource> loadAssetPcm16(const std::string &filename) {
+    const AudioProperties properties{kChannelCount, kSampleRate};
+    std::vector<uint8_t> file = readAssetFile(filename);
+
+    std::unique_ptr<int16_t[]> decoded;
+    const int64_t numSamples = WavDecoder::decode(file.data(), file.size(), properties, decoded);
+    if (numSamples == 0) return nullptr;
+
+    return std::make_shared<Pcm16DataSource>(std::move(decoded), numSamples, properties);
+}
+
+#endif //METRONOMEPLUS_HOSTAUDIO_H
@@ -0,0 +1,167 @@
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "HostAudio.h"
+#include "audio/Limiter.h"
+#include "audio/Mixer.h"
+#include "audio/Player.h"
+
+namespace {
+
+constexpr float kTwoPi = 6.283185307f;
+// The release time constant
+constexpr int64_t kReleaseFrames = kSampleRate / 10;
+
+std::vector<float> sine(float amplitude, float frequencyHz, int64_t numFrames) {
+    std::vector<float> samples(static_cast<size_t>(numFrames * kChannelCount));
+    for (int64_t i = 0; i < numFrames; ++i) {
+        const float value = amplitude * std::sin(kTwoPi * frequencyHz * i / kSampleRate);
+        for (int32_t j = 0; j < kChannelCount; ++j) {
+            samples[i * kChannelCount + j] = value;
+        }
+    }
+    return samples;
+}
+
+void processInBursts(Limiter &limiter, std::vector<float> &samples, uint32_t seed,
+                     int32_t channelCount = kChannelCount, int32_t maxBurstFrames = 1024) {
+    std::mt19937 random(seed);
+    std::uniform_int_distribution<int32_t> burst(1, maxBurstFrames);
+
+    limiter.setChannelCount(channelCount);
+    const int64_t numFrames = samples.size() / channelCount;
+    int64_t position = 0;
+    while (position < numFrames) {
+        const int32_t framesToProcess = static_cast<int32_t>(
+                std::min<int64_t>(burst(random), numFrames - position));
+        limiter.process(&samples[position * channelCount], framesToProcess);
+        position += framesToProcess;
+    }
+}
+
+float peakOf(const std::vector<float> &samples, size_t begin = 0) {
+    float peak = 0;
+    for (size_t i = begin; i < samples.size(); ++i) peak = std::max(peak, std::abs(samples[i]));
+    return peak;
+}
+
+}
+
+TEST(LimiterTest, leavesSignalsBelowTheKneeUntouched) {
+    Limiter limiter(kSampleRate);
+    const std::vector<float> input = sine(kLimiterKnee, 440, kSampleRate);
+
+    std::vector<float> output = input;
+    processInBursts(limiter, output, 1);
+
+    EXPECT_EQ(input, output);
+    EXPECT_EQ(0, limiter.takeGainReductionDb());
+}
+
+TEST(LimiterTest, neverExceedsTheCeiling) {
+    for (float amplitude : {0.9f, 1.0f, 1.5f, 4.0f, 100.0f}) {
+        Limiter limiter(kSampleRate);
+        std::vector<float> output = sine(amplitude, 997, kSampleRate);
+        processInBursts(limiter, output, 2);
+
+        EXPECT_LE(peakOf(output), kLimiterCeiling) << "amplitude " << amplitude;
+    }
+}
+
+TEST(LimiterTest, gainReductionIsSmoothAndReleases) {
+    Limiter limiter(kSampleRate);
+
+    // A loud burst followed by a quiet tone, which must come back to unity gain
+    std::vector<float> samples = sine(3.0f, 200, kSampleRate / 4);
+    const std::vector<float> quiet = sine(0.5f, 200, kSampleRate * 3 / 2);
+    const size_t quietStart = samples.size();
+    samples.insert(samples.end(), quiet.begin(), quiet.end());
+
+    processInBursts(limiter, samples, 3);
+
+    EXPECT_GT(limiter.takeGainReductionDb(), 6.0f);
+    EXPECT_EQ(0, limiter.takeGainReductionDb());
+
+    // No steps: a 200 Hz tone changes by at most about 0.08 per sample at full scale
+    for (size_t i = kChannelCount; i < samples.size(); ++i) {
+        ASSERT_LE(std::abs(samples[i] - samples[i - kChannelCount]), 0.1f) << "sample " << i;
+    }
+
+    // Released after ten time constants
+    const size_t releasedStart = quietStart + kReleaseFrames * 10 * kChannelCount;
+    for (size_t i = releasedStart; i < samples.size(); ++i) {
+        ASSERT_NEAR(quiet[i - quietStart], samples[i], 1e-6f) << "sample " << i;
+    }
+}
+
+TEST(LimiterTest, releaseTimeDoesNotDependOnLayoutOrBlockSizes) {
+    constexpr float loudLevel = 4.0f;
+    constexpr float quietLevel = 0.5f;
+    constexpr int64_t loudFrames = kSampleRate / 20;
+    constexpr int64_t quietFrames = kReleaseFrames * 3;
+
+    for (int32_t channelCount : {1, 2, 8}) {
+        // Small bursts cut most chunks short
+        for (int32_t maxBurstFrames : {1024, 40}) {
+            SCOPED_TRACE(::testing::Message() << channelCount << " channels, bursts up to "
+                                              << maxBurstFrames);
+
+            // A constant level held down to the ceiling, then one below the knee, so the output
+            // of the quiet part traces the gain
+            std::vector<float> samples(static_cast<size_t>((loudFrames + quietFrames) *
+                                                           channelCount), quietLevel);
+            std::fill(samples.begin(), samples.begin() + loudFrames * channelCount, loudLevel);
+
+            Limiter limiter(kSampleRate);
+            processInBursts(limiter, samples, 4, channelCount, maxBurstFrames);
+
+            // Recovers 1 - 1/e of the way to unity every time constant, give or take a chunk
+            const float heldGain = kLimiterCeiling / loudLevel;
+            for (int64_t frame = kReleaseFrames / 2; frame < quietFrames;
+                 frame += kReleaseFrames / 2) {
+                const float expectedGain = 1 - (1 - heldGain) *
+                        std::exp(-static_cast<float>(frame) / kReleaseFrames);
+                const size_t sample = static_cast<size_t>((loudFrames + frame) * channelCount);
+                for (int32_t channel = 0; channel < channelCount; ++channel) {
+                    ASSERT_NEAR(expectedGain, samples[sample + channel] / quietLevel, 0.01f)
+                            << "frame " << frame << " channel " << channel;
+                }
+            }
+        }
+    }
+}
+
+TEST(LimiterTest, saturatorIsMonotonicAndBounded) {
+    float previous = 0;
+    for (float sample = 0; sample < 20; sample += 0.001f) {
+        const float limited = limiterSaturate(sample);
+        ASSERT_GE(limited, previous) << "sample " << sample;
+        ASSERT_LT(limited, kLimiterCeiling) << "sample " << sample;
+        ASSERT_EQ(-limited, limiterSaturate(-sample)) << "sample " << sample;
+        previous = limited;
+    }
+    EXPECT_EQ(0.5f, limiterSaturate(0.5f));
+}
+
+TEST(LimiterTest, mixerOutputOfOverlappingSoundsStaysBelowCeiling) {
+    std::shared_ptr<DataSource> source = loadAsset(kAccentBeat);
+
+    Mixer mixer;
+    mixer.setChannelCount(kChannelCount);
+    std::vector<std::unique_ptr<Player>> players;
+    for (int i = 0; i < 4; ++i) {
+        players.push_back(std::make_unique<Player>(source));
+        players.back()->setPlaying(true);
+        mixer.addTrack(players.back().get());
+    }
+
+    std::vector<float> output(static_cast<size_t>(4096 * kChannelCount));
+    mixer.renderAudio(output.data(), 4096);
+
+    EXPECT_GT(peakOf(output), kLimiterKnee);
+    EXPECT_LE(peakOf(output), kLimiterCeiling);
+    EXPECT_GT(mixer.takeGainReductionDb(), 0);
+}
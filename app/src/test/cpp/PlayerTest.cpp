@@ -0,0 +1,89 @@
+#include <limits>
+#include <random>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "HostAudio.h"
+#include "audio/Player.h"
+#include "audio/SampleConversion.h"
+
+namespace {
+
+std::vector<float> renderInBursts(Player &player, int64_t numFrames, uint32_t seed) {
+    std::vector<float> output(static_cast<size_t>(numFrames * kChannelCount));
+    std::mt19937 random(seed);
+    std::uniform_int_distribution<int32_t> burst(1, 1024);
+
+    int64_t position = 0;
+    while (position < numFrames) {
+        const int32_t framesToRender = static_cast<int32_t>(
+                std::min<int64_t>(burst(random), numFrames - position));
+        player.renderAudio(&output[position * kChannelCount], framesToRender);
+        position += framesToRender;
+    }
+    return output;
+}
+
+}
+
+TEST(PlayerTest, pcm16SourcePlaysExactlyLikeFloatSource) {
+    std::shared_ptr<DataSource> floatSource = loadAsset(kNormalBeat);
+    std::shared_ptr<DataSource> pcm16Source = loadAssetPcm16(kNormalBeat);
+    ASSERT_TRUE(floatSource && pcm16Source);
+    ASSERT_EQ(floatSource->getSize(), pcm16Source->getSize());
+    EXPECT_EQ(nullptr, pcm16Source->getData());
+
+    const int64_t sourceFrames = floatSource->getSize() / kChannelCount;
+
+    for (bool isLooping : {false, true}) {
+        Player floatPlayer(floatSource);
+        Player pcm16Player(pcm16Source);
+        floatPlayer.setLooping(isLooping);
+        pcm16Player.setLooping(isLooping);
+        floatPlayer.setPlaying(true);
+        pcm16Player.setPlaying(true);
+
+        // Long enough to wrap around twice when looping, and to end in silence otherwise
+        const std::vector<float> expected = renderInBursts(floatPlayer, sourceFrames * 5 / 2, 1);
+        const std::vector<float> actual = renderInBursts(pcm16Player, sourceFrames * 5 / 2, 2);
+
+        ASSERT_EQ(expected, actual) << "looping " << isLooping;
+    }
+}
+
+TEST(PlayerTest, playsTheSourceOnceThenSilence) {
+    std::shared_ptr<DataSource> source = loadAsset(kNormalBeat);
+    Player player(source);
+    player.setPlaying(true);
+
+    const int64_t sourceFrames = source->getSize() / kChannelCount;
+    const std::vector<float> output = renderInBursts(player, sourceFrames + 500, 3);
+
+    for (int64_t i = 0; i < source->getSize(); ++i) {
+        ASSERT_EQ(source->getData()[i], output[i]) << "sample " << i;
+    }
+    for (size_t i = source->getSize(); i < output.size(); ++i) {
+        ASSERT_EQ(0, output[i]) << "sample " << i;
+    }
+}
+
+TEST(PlayerTest, convertPcm16ToFloatHandlesFullRangeAndTails) {
+    const int16_t extremes[]{std::numeric_limits<int16_t>::min(), -1, 0, 1,
+                             std::numeric_limits<int16_t>::max()};
+
+    // Every length up to a few vector widths, so both the vector loop and the tail are exercised
+    for (int64_t numSamples = 0; numSamples <= 37; ++numSamples) {
+        std::vector<int16_t> input(static_cast<size_t>(numSamples));
+        for (int64_t i = 0; i < numSamples; ++i) {
+            input[i] = extremes[i % 5];
+        }
+
+        std::vector<float> output(static_cast<size_t>(numSamples));
+        convertPcm16ToFloat(input.data(), output.data(), numSamples);
+
+        for (int64_t i = 0; i < numSamples; ++i) {
+            EXPECT_EQ(input[i] / 32768.0f, output[i]) << "length " << numSamples << ", " << i;
+        }
+    }
+}
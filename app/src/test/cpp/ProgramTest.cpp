@@ -0,0 +1,220 @@
+#include <cstdio>
+#include <fstream>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "HostAudio.h"
+#include "TimingHarness.h"
+#include "audio/Mixer.h"
+#include "audio/Player.h"
+#include "audio/Sequencer.h"
+#include "program/Program.h"
+#include "program/ProgramCompiler.h"
+
+namespace {
+
+const char kSetlist[] = R"(
+# Two songs
+song Warm up
+bar 120 N N N N x2
+
+song Tempo map
+count-in 60 N N
+bar 240 A N         # loops back here
+gap 240 2
+)";
+
+std::vector<uint8_t> compileOrFail(const char *source) {
+    std::vector<uint8_t> compiled;
+    std::string error;
+    EXPECT_TRUE(ProgramCompiler::compile(source, &compiled, &error)) << error;
+    return compiled;
+}
+
+std::string compileError(const char *source) {
+    std::vector<uint8_t> compiled;
+    std::string error;
+    EXPECT_FALSE(ProgramCompiler::compile(source, &compiled, &error));
+    return error;
+}
+
+}
+
+TEST(ProgramTest, compiledProgramLoadsInPlace) {
+    std::vector<uint8_t> compiled = compileOrFail(kSetlist);
+
+    std::unique_ptr<Program> program = Program::fromBuffer(compiled.data(), compiled.size());
+    ASSERT_NE(nullptr, program);
+    ASSERT_EQ(2, program->getSongCount());
+    EXPECT_EQ("Warm up", program->getSongName(0));
+    EXPECT_EQ("Tempo map", program->getSongName(1));
+    EXPECT_EQ(nullptr, program->getSong(2));
+
+    const SongTimeline *warmUp = program->getSong(0);
+    EXPECT_EQ(2u, warmUp->barCount);
+    EXPECT_EQ(0u, warmUp->loopBar);
+    EXPECT_EQ(120, warmUp->bars[1].bpm);
+
+    const SongTimeline *tempoMap = program->getSong(1);
+    ASSERT_EQ(3u, tempoMap->barCount);
+    EXPECT_EQ(1u, tempoMap->loopBar);
+    EXPECT_EQ(kProgramBarCountIn, tempoMap->bars[0].flags);
+    EXPECT_EQ(kProgramBarMuted, tempoMap->bars[2].flags);
+    EXPECT_EQ(BeatState::Accent, tempoMap->beats[tempoMap->bars[1].firstBeat]);
+
+    // The timelines point into the compiled data, nothing is copied
+    EXPECT_GE(reinterpret_cast<const uint8_t *>(tempoMap->bars), compiled.data());
+    EXPECT_LT(reinterpret_cast<const uint8_t *>(tempoMap->bars), compiled.data() + compiled.size());
+}
+
+TEST(ProgramTest, programFileIsMemoryMapped) {
+    std::vector<uint8_t> compiled = compileOrFail(kSetlist);
+    const std::string path = ::testing::TempDir() + "program_test.mpp";
+    std::ofstream(path, std::ios::binary)
+            .write(reinterpret_cast<const char *>(compiled.data()),
+                   static_cast<std::streamsize>(compiled.size()));
+
+    std::unique_ptr<Program> program = Program::fromFile(path.c_str());
+    ASSERT_NE(nullptr, program);
+    EXPECT_EQ(2, program->getSongCount());
+    EXPECT_EQ(nullptr, Program::fromFile((path + ".missing").c_str()));
+
+    std::remove(path.c_str());
+}
+
+TEST(ProgramTest, compilerReportsErrorsWithLineNumbers) {
+    EXPECT_EQ("line 1: bars must follow a song statement", compileError("bar 120 N"));
+    EXPECT_EQ("line 2: unknown beat 'Q'", compileError("song A\nbar 120 N Q"));
+    EXPECT_EQ("line 2: expected a bpm between 1 and 1000", compileError("song A\nbar 0 N"));
+    EXPECT_EQ("line 3: count-in bars must come first in a song",
+              compileError("song A\nbar 120 N\ncount-in 120 N"));
+    EXPECT_EQ("line 2: unknown statement 'bars'", compileError("song A\nbars 120 N"));
+    EXPECT_EQ("song 'A' has no bars", compileError("song A\n"));
+    EXPECT_EQ("no songs", compileError("# empty\n"));
+}
+
+TEST(ProgramTest, validateRejectsCorruptPrograms) {
+    const std::vector<uint8_t> compiled = compileOrFail(kSetlist);
+    std::string error;
+
+    ASSERT_TRUE(Program::validate(compiled.data(), compiled.size(), &error)) << error;
+
+    EXPECT_FALSE(Program::validate(compiled.data(), compiled.size() - 1, &error));
+    EXPECT_FALSE(Program::validate(compiled.data(), sizeof(ProgramHeader) - 1, &error));
+
+    std::vector<uint8_t> badMagic = compiled;
+    badMagic[0] = 'X';
+    EXPECT_FALSE(Program::validate(badMagic.data(), badMagic.size(), &error));
+    EXPECT_EQ("not a program file", error);
+
+    std::vector<uint8_t> badBeat = compiled;
+    badBeat[badBeat.size() - 1] = kBeatStateCount;
+    EXPECT_FALSE(Program::validate(badBeat.data(), badBeat.size(), &error));
+
+    std::vector<uint8_t> badVersion = compiled;
+    badVersion[4] = kProgramVersion + 1;
+    EXPECT_FALSE(Program::validate(badVersion.data(), badVersion.size(), &error));
+}
+
+TEST(ProgramTest, songsSwitchGaplesslyAtTheNextBar) {
+    std::vector<uint8_t> compiled = compileOrFail(kSetlist);
+    std::unique_ptr<Program> program = Program::fromBuffer(compiled.data(), compiled.size());
+    ASSERT_NE(nullptr, program);
+
+    std::vector<float> click(32 * kChannelCount, 0.0f);
+    click[0] = click[1] = 1.0f;
+    Player player(std::make_shared<BufferDataSource>(click, AudioProperties{kChannelCount, kSampleRate}));
+
+    Mixer mixer;
+    mixer.setChannelCount(kChannelCount);
+    mixer.addTrack(&player);
+    Sequencer sequencer(mixer, kSampleRate);
+    sequencer.setPlayer(BeatState::Normal, &player);
+    sequencer.setPlayer(BeatState::Accent, &player);
+    sequencer.queueSong(program->getSong(0));
+    sequencer.start();
+
+    constexpr int32_t kBurstFrames = 256;
+    std::vector<float> output(kBurstFrames * kChannelCount);
+    std::vector<int64_t> onsets;
+    bool isAboveThreshold = false;
+
+    for (int64_t clock = 0; clock < 260000; clock += kBurstFrames) {
+        // Mid-bar: the new song must wait for the bar line at frame 96000
+        if (clock == 30208) {
+            sequencer.queueSong(program->getSong(1));
+        }
+        sequencer.renderAudio(output.data(), kBurstFrames);
+
+        for (int64_t onset : TimingHarness::detectOnsets(output.data(), kBurstFrames,
+                                                         kChannelCount, clock,
+                                                         &isAboveThreshold)) {
+            onsets.push_back(onset);
+        }
+    }
+
+    const std::vector<int64_t> expected{
+            // Warm up, 120 BPM
+            0, 24000, 48000, 72000,
+            // Count-in at 60 BPM
+            96000, 144000,
+            // 240 BPM, then a muted bar, then the song loops after its count-in
+            192000, 204000, 240000, 252000,
+    };
+    EXPECT_EQ(expected, onsets);
+}
+
+TEST(ProgramTest, countInBarsPlayTheirOwnPlayer) {
+    std::vector<uint8_t> compiled = compileOrFail(kSetlist);
+    std::unique_ptr<Program> program = Program::fromBuffer(compiled.data(), compiled.size());
+    ASSERT_NE(nullptr, program);
+
+    // The count-in click is inverted so the two can be told apart in the mix
+    std::vector<float> click(32 * kChannelCount, 0.0f);
+    click[0] = click[1] = 1.0f;
+    std::vector<float> countInClick(32 * kChannelCount, 0.0f);
+    countInClick[0] = countInClick[1] = -1.0f;
+    const AudioProperties properties{kChannelCount, kSampleRate};
+    Player player(std::make_shared<BufferDataSource>(click, properties));
+    Player countInPlayer(std::make_shared<BufferDataSource>(countInClick, properties));
+
+    Mixer mixer;
+    mixer.setChannelCount(kChannelCount);
+    mixer.addTrack(&player);
+    mixer.addTrack(&countInPlayer, Bus::Cue);
+    Sequencer sequencer(mixer, kSampleRate);
+    sequencer.setPlayer(BeatState::Normal, &player);
+    sequencer.setPlayer(BeatState::Accent, &player);
+    sequencer.setCountInPlayer(BeatState::Normal, &countInPlayer);
+    sequencer.queueSong(program->getSong(1));
+    sequencer.start();
+
+    constexpr int32_t kBurstFrames = 256;
+    std::vector<float> output(kBurstFrames * kChannelCount);
+    std::vector<int64_t> onsets;
+    std::vector<int64_t> countInOnsets;
+    bool isAboveThreshold = false;
+    bool isCountInAboveThreshold = false;
+
+    for (int64_t clock = 0; clock < 150000; clock += kBurstFrames) {
+        sequencer.renderAudio(output.data(), kBurstFrames);
+
+        for (int64_t onset : TimingHarness::detectOnsets(output.data(), kBurstFrames,
+                                                         kChannelCount, clock,
+                                                         &isAboveThreshold)) {
+            onsets.push_back(onset);
+        }
+        for (float &sample : output) sample = -sample;
+        for (int64_t onset : TimingHarness::detectOnsets(output.data(), kBurstFrames,
+                                                         kChannelCount, clock,
+                                                         &isCountInAboveThreshold)) {
+            countInOnsets.push_back(onset);
+        }
+    }
+
+    // Two count-in beats at 60 BPM, then the 240 BPM bar, a muted one, and the loop back to the
+    // 240 BPM bar without the count-in
+    EXPECT_EQ((std::vector<int64_t>{0, 48000}), countInOnsets);
+    EXPECT_EQ((std::vector<int64_t>{96000, 108000, 144000}), onsets);
+}
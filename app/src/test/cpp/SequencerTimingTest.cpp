@@ -0,0 +1,110 @@
+#include <gtest/gtest.h>
+
+#include "TimingHarness.h"
+
+namespace {
+
+constexpr double kMaxOnsetErrorFrames = 1.0;
+constexpr int64_t kOneHourFrames = 48000LL * 60 * 60;
+
+void expectSampleAccurate(const TimingReport &report, const TimingConfig &config) {
+    SCOPED_TRACE(::testing::Message() << "bpm " << config.bpm
+                                      << ", bursts " << config.minBurstFrames
+                                      << "-" << config.maxBurstFrames);
+
+    EXPECT_EQ(report.expectedOnsets, report.detectedOnsets);
+    EXPECT_LE(report.maxErrorFrames, kMaxOnsetErrorFrames);
+    EXPECT_LE(report.rmsErrorFrames, kMaxOnsetErrorFrames);
+    EXPECT_LE(std::abs(report.driftFrames), kMaxOnsetErrorFrames);
+}
+
+}
+
+TEST(SequencerTimingTest, everyBpmLandsOnTheGridWithJitteryBursts) {
+    TimingHarness harness;
+
+    for (int bpm = 20; bpm <= 400; ++bpm) {
+        TimingConfig config;
+        config.bpm = bpm;
+        config.durationFrames = static_cast<int64_t>(config.sampleRate * 60.0 / bpm * 16);
+        config.minBurstFrames = 1;
+        config.maxBurstFrames = 1024;
+        config.seed = static_cast<uint32_t>(bpm);
+
+        expectSampleAccurate(harness.run(config), config);
+    }
+}
+
+TEST(SequencerTimingTest, onsetsDoNotDriftOverHourLongSessions) {
+    TimingHarness harness;
+
+    const TimingConfig sessions[] = {
+            // Low latency bursts with small jitter
+            {23, 48000, kOneHourFrames, 180, 200, 7},
+            // Odd burst sizes typical of resampled streams
+            {120, 48000, kOneHourFrames, 1, 997, 11},
+            // Power saving mode sized callbacks
+            {333, 48000, kOneHourFrames, 4096, 4096, 13},
+    };
+
+    for (const TimingConfig &config : sessions) {
+        const TimingReport report = harness.run(config);
+        expectSampleAccurate(report, config);
+
+        RecordProperty("bpm_" + std::to_string(config.bpm) + "_max_error",
+                       std::to_string(report.maxErrorFrames));
+        RecordProperty("bpm_" + std::to_string(config.bpm) + "_rms_error",
+                       std::to_string(report.rmsErrorFrames));
+    }
+}
+
+TEST(SequencerTimingTest, skippedFramesKeepTheBeatPhase) {
+    TimingHarness harness;
+
+    TimingConfig config;
+    config.bpm = 97;
+    config.durationFrames = 48000LL * 60 * 10;
+    config.minBurstFrames = 64;
+    config.maxBurstFrames = 4096;
+    config.skipIntervalFrames = 48000 * 7;
+    config.skippedFrames = 48000 / 3;
+
+    const TimingReport report = harness.run(config);
+
+    EXPECT_GT(report.detectedOnsets, 0);
+    expectSampleAccurate(report, config);
+}
+
+TEST(SequencerTimingTest, reopeningWithAnotherLatencyKeepsTheBeatPhase) {
+    TimingHarness harness;
+
+    TimingConfig config;
+    config.bpm = 131;
+    config.durationFrames = 48000LL * 60 * 10;
+    config.minBurstFrames = 96;
+    config.maxBurstFrames = 4096;
+    config.skipIntervalFrames = 48000 * 5;
+    // Shorter than the latency difference, so going back to low latency has to catch up on
+    // frames the power saving stream never played
+    config.skippedFrames = 48000 / 50;
+    // Low latency and power saving
+    config.outputLatencyFrames[0] = 480;
+    config.outputLatencyFrames[1] = 48000 / 5;
+
+    const TimingReport report = harness.run(config);
+
+    EXPECT_GT(report.detectedOnsets, 0);
+    expectSampleAccurate(report, config);
+}
+
+TEST(SequencerTimingTest, detectOnsetsReportsRisingEdgesOnly) {
+    const float output[] = {0, 0, 1, 1, 0.25f, 0, 0.9f, 0.1f};
+    bool isAboveThreshold = false;
+
+    std::vector<int64_t> onsets =
+            TimingHarness::detectOnsets(output, 4, 2, 100, &isAboveThreshold);
+
+    ASSERT_EQ(2u, onsets.size());
+    EXPECT_EQ(101, onsets[0]);
+    EXPECT_EQ(103, onsets[1]);
+}
@@ -0,0 +1,192 @@
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "HostAudio.h"
+#include "analysis/OnsetDetector.h"
+#include "analysis/TimingAnalyzer.h"
+
+namespace {
+
+constexpr int32_t kFramesPerBeat = kSampleRate / 2;
+constexpr int32_t kNoteCount = 16;
+constexpr float kNoiseAmplitude = 0.001f;
+constexpr float kMaxDeviationErrorMs = 1.0f;
+
+// How early or late each played note is, in milliseconds
+const std::vector<float> kPlayedDeviationsMs{0, 12.5f, -20, 5, -3, 31, -47, 0.5f};
+
+struct Recording {
+    std::vector<float> samples;
+    std::vector<float> deviationsMs;
+};
+
+/**
+ * First channel of a bundled sound, and where its attack starts: the first sample within 26 dB
+ * of its peak.
+ */
+std::vector<float> loadMonoAsset(const std::string &filename, int32_t *attackFrame) {
+    std::shared_ptr<BufferDataSource> source = loadAsset(filename);
+    std::vector<float> mono;
+    if (!source) return mono;
+
+    const int32_t channelCount = source->getProperties().channelCount;
+    for (int64_t i = 0; i < source->getSize(); i += channelCount) {
+        mono.push_back(source->getData()[i]);
+    }
+
+    float peak = 0;
+    for (float sample : mono) peak = std::max(peak, std::abs(sample));
+    *attackFrame = 0;
+    while (std::abs(mono[*attackFrame]) <= peak * 0.05f) ++*attackFrame;
+    return mono;
+}
+
+/**
+ * Simulates a player hitting `note` once per beat with a deliberate deviation, cycling through
+ * `deviationsMs`, over a noise floor. Beat `n` is scheduled on frame `(n + 1) * kFramesPerBeat`.
+ */
+Recording recordPerformance(const std::vector<float> &note, int32_t attackFrame,
+                            const std::vector<float> &deviationsMs = kPlayedDeviationsMs) {
+    Recording recording;
+    recording.samples.resize(static_cast<size_t>(kFramesPerBeat) * (kNoteCount + 2));
+
+    std::mt19937 random(1);
+    std::uniform_real_distribution<float> noise(-kNoiseAmplitude, kNoiseAmplitude);
+    for (float &sample : recording.samples) sample = noise(random);
+
+    for (int32_t n = 0; n < kNoteCount; ++n) {
+        const float deviationMs = deviationsMs[n % deviationsMs.size()];
+        const int64_t attack = static_cast<int64_t>(n + 1) * kFramesPerBeat +
+                               std::lround(deviationMs * kSampleRate / 1000);
+        const int64_t start = attack - attackFrame;
+
+        for (size_t i = 0; i < note.size() && start + i < recording.samples.size(); ++i) {
+            recording.samples[start + i] += note[i];
+        }
+        recording.deviationsMs.push_back(deviationMs);
+    }
+    return recording;
+}
+
+/**
+ * Feeds `input` through the analyzer in random bursts, as an input stream would. The output is
+ * rendered in step with the input, so a beat is only announced once the block it falls in has been
+ * rendered. `latencyFrames` delays the input relative to the beats, and is compensated when
+ * mapping input frames onto the beat clock.
+ */
+std::vector<TimingResult> analyze(const std::vector<float> &input, int64_t latencyFrames) {
+    TimingAnalyzer analyzer(kSampleRate);
+    std::mt19937 random(7);
+    std::uniform_int_distribution<int32_t> burst(1, 1024);
+
+    std::vector<float> delayed(static_cast<size_t>(latencyFrames), 0);
+    delayed.insert(delayed.end(), input.begin(), input.end());
+
+    int64_t nextBeatFrame = kFramesPerBeat;
+    int64_t position = 0;
+    while (position < static_cast<int64_t>(delayed.size())) {
+        const int32_t numFrames = static_cast<int32_t>(
+                std::min<int64_t>(burst(random), delayed.size() - position));
+
+        // The input trails the output by the latency, the output has caught up with this block
+        const int64_t firstOutputFrame = position - latencyFrames;
+        const int64_t renderedFrame = position + numFrames;
+        while (nextBeatFrame < renderedFrame) {
+            analyzer.onBeat(nextBeatFrame);
+            nextBeatFrame += kFramesPerBeat;
+        }
+
+        analyzer.processInput(&delayed[position], numFrames, firstOutputFrame, renderedFrame);
+        position += numFrames;
+    }
+
+    std::vector<TimingResult> results;
+    TimingResult result;
+    while (analyzer.popResult(&result)) results.push_back(result);
+    return results;
+}
+
+void expectDeviations(const Recording &recording, const std::vector<TimingResult> &results) {
+    ASSERT_EQ(recording.deviationsMs.size(), results.size());
+
+    for (size_t n = 0; n < results.size(); ++n) {
+        SCOPED_TRACE(::testing::Message() << "note " << n);
+        EXPECT_EQ(static_cast<int64_t>(n + 1) * kFramesPerBeat, results[n].beatFrame);
+        EXPECT_NEAR(recording.deviationsMs[n], results[n].deviationMs, kMaxDeviationErrorMs);
+    }
+}
+
+}
+
+TEST(TimingAnalyzerTest, measuresDeviationOfEveryBundledSound) {
+    for (const char *filename : kBundledBeats) {
+        SCOPED_TRACE(filename);
+
+        int32_t attackFrame;
+        const std::vector<float> note = loadMonoAsset(filename, &attackFrame);
+        ASSERT_FALSE(note.empty());
+
+        const Recording recording = recordPerformance(note, attackFrame);
+        expectDeviations(recording, analyze(recording.samples, 0));
+    }
+}
+
+TEST(TimingAnalyzerTest, compensatesRoundTripLatency) {
+    int32_t attackFrame;
+    const std::vector<float> note = loadMonoAsset(kNormalBeat, &attackFrame);
+    const Recording recording = recordPerformance(note, attackFrame);
+
+    // 95 ms, well beyond the largest deviation, so an uncompensated input would miss every beat
+    expectDeviations(recording, analyze(recording.samples, 4560));
+}
+
+TEST(TimingAnalyzerTest, matchesNotesPlayedAheadOfUnrenderedBeats) {
+    int32_t attackFrame;
+    const std::vector<float> note = loadMonoAsset(kNormalBeat, &attackFrame);
+    // Rushing, each note comes in before the output has reached its beat
+    const Recording recording = recordPerformance(note, attackFrame, {-30, -42, -50, -35});
+
+    expectDeviations(recording, analyze(recording.samples, 0));
+    // Less latency than rushing, the beat is still ahead of the output when the note is heard
+    expectDeviations(recording, analyze(recording.samples, 960));
+}
+
+TEST(TimingAnalyzerTest, ignoresNoiseAndNotesOffTheGrid) {
+    std::vector<float> input(static_cast<size_t>(kFramesPerBeat) * 4);
+    std::mt19937 random(3);
+    std::uniform_real_distribution<float> noise(-kNoiseAmplitude, kNoiseAmplitude);
+    for (float &sample : input) sample = noise(random);
+
+    EXPECT_TRUE(analyze(input, 0).empty());
+
+    // Half way between two beats
+    int32_t attackFrame;
+    const std::vector<float> note = loadMonoAsset(kNormalBeat, &attackFrame);
+    const size_t start = kFramesPerBeat * 3 / 2 - attackFrame;
+    for (size_t i = 0; i < note.size(); ++i) input[start + i] += note[i];
+
+    EXPECT_TRUE(analyze(input, 0).empty());
+}
+
+TEST(TimingAnalyzerTest, detectorFindsAttackAcrossHopBoundaries) {
+    for (int32_t offset = 0; offset < kOnsetHopFrames; offset += 7) {
+        std::vector<float> input(4096, 0);
+        const int64_t attack = 1024 + offset;
+        for (int64_t i = attack; i < attack + 256; ++i) {
+            input[i] = (i % 2 == 0) ? 0.5f : -0.5f;
+        }
+
+        OnsetDetector detector(kSampleRate);
+        int64_t onsets[4];
+        const int32_t onsetCount = detector.process(input.data(),
+                                                    static_cast<int32_t>(input.size()),
+                                                    onsets, 4);
+        ASSERT_EQ(1, onsetCount) << "offset " << offset;
+        EXPECT_EQ(attack, onsets[0]) << "offset " << offset;
+    }
+}
@@ -0,0 +1,141 @@
+#include <cmath>
+#include <random>
+
+#include "TimingHarness.h"
+#include "HostAudio.h"
+#include "audio/Mixer.h"
+#include "audio/Player.h"
+#include "audio/Sequencer.h"
+
+constexpr float kOnsetThreshold { 0.5f };
+constexpr int32_t kClickFrames { 32 };
+
+TimingHarness::TimingHarness() {
+    // A sharp click: a full scale first frame followed by a short, quieter tail
+    std::vector<float> click(kClickFrames * kChannelCount, 0.25f);
+    for (int32_t channel = 0; channel < kChannelCount; ++channel) {
+        click[channel] = 1.0f;
+    }
+    mClick = std::make_shared<BufferDataSource>(click, AudioProperties{kChannelCount, kSampleRate});
+}
+
+TimingReport TimingHarness::run(const TimingConfig &config) {
+
+    Mixer mixer;
+    mixer.setChannelCount(kChannelCount);
+    Player player(mClick);
+    mixer.addTrack(&player);
+
+    Sequencer sequencer(mixer, config.sampleRate);
+    sequencer.setPlayer(BeatState::Normal, &player);
+    sequencer.setBeats({{BeatState::Normal}});
+    sequencer.setBPM(config.bpm);
+    sequencer.start();
+
+    std::mt19937 random(config.seed);
+    std::uniform_int_distribution<int32_t> burstSizes(config.minBurstFrames, config.maxBurstFrames);
+    std::vector<float> output(config.maxBurstFrames * kChannelCount);
+
+    const double framesPerBeat = config.sampleRate * 60.0 / config.bpm;
+    // Onsets can only start on whole frames, so a grid point belongs to the frame it rounds to
+    auto gridPointsBefore = [framesPerBeat](int64_t frame) {
+        return static_cast<int64_t>(std::ceil((frame - 0.5) / framesPerBeat));
+    };
+
+    TimingReport report;
+
+    double sumSquaredError = 0;
+    double firstError = 0;
+    double lastError = 0;
+    bool isAboveThreshold = false;
+
+    auto scoreOnset = [&](int64_t onset) {
+        const double ideal = std::round(onset / framesPerBeat) * framesPerBeat;
+        const double error = onset - ideal;
+
+        if (report.detectedOnsets == 0) firstError = error;
+        lastError = error;
+        report.maxErrorFrames = std::max(report.maxErrorFrames, std::abs(error));
+        sumSquaredError += error * error;
+        ++report.detectedOnsets;
+    };
+
+    // Onsets and the grid are on the clock of the first stream: a frame rendered at `clock` is
+    // heard at `clock + latency - referenceLatency` on it
+    const int64_t referenceLatency = config.outputLatencyFrames[0];
+    int64_t latency = referenceLatency;
+    int32_t streamIndex = 0;
+    // Rendered onsets not scored yet, they still have to be heard
+    std::vector<int64_t> pendingOnsets;
+    // Where the current stream's output started being heard
+    int64_t heardStart = 0;
+
+    auto hearUntil = [&](int64_t heardEnd) {
+        heardEnd = std::max(heardEnd, heardStart);
+        report.expectedOnsets += gridPointsBefore(heardEnd) - gridPointsBefore(heardStart);
+        for (int64_t onset : pendingOnsets) {
+            if (onset < heardEnd) scoreOnset(onset);
+        }
+        pendingOnsets.clear();
+    };
+
+    int64_t clock = 0;
+    int64_t nextSkipFrame = config.skipIntervalFrames;
+    while (clock < config.durationFrames) {
+        if (config.skipIntervalFrames > 0 && clock >= nextSkipFrame) {
+            hearUntil(clock - referenceLatency);
+
+            // Reopen the way the Metronome does: from the frame being heard, past the time the
+            // stream is down and the new stream's latency
+            streamIndex = 1 - streamIndex;
+            const int64_t newLatency = config.outputLatencyFrames[streamIndex];
+            const int64_t framePosition = sequencer.getFramePosition() - latency +
+                                          config.skippedFrames + newLatency;
+            // Frames rendered again as silence are not heard either
+            const int64_t heldFrames =
+                    std::max<int64_t>(sequencer.getFramePosition() - framePosition, 0);
+            sequencer.seekTo(framePosition);
+
+            clock += config.skippedFrames;
+            latency = newLatency;
+            heardStart = clock + latency - referenceLatency + heldFrames;
+            nextSkipFrame = clock + config.skipIntervalFrames;
+            isAboveThreshold = false;
+            continue;
+        }
+
+        const auto numFrames = static_cast<int32_t>(
+                std::min<int64_t>(burstSizes(random), config.durationFrames - clock));
+
+        sequencer.renderAudio(output.data(), numFrames);
+
+        for (int64_t onset : detectOnsets(output.data(), numFrames, kChannelCount,
+                                          clock + latency - referenceLatency,
+                                          &isAboveThreshold)) {
+            pendingOnsets.push_back(onset);
+        }
+        clock += numFrames;
+    }
+    // The last stream plays out everything it was given
+    hearUntil(clock + latency - referenceLatency);
+
+    if (report.detectedOnsets > 0) {
+        report.rmsErrorFrames = std::sqrt(sumSquaredError / report.detectedOnsets);
+        report.driftFrames = lastError - firstError;
+    }
+    return report;
+}
+
+std::vector<int64_t> TimingHarness::detectOnsets(const float *output, int32_t numFrames,
+                                                 int32_t channelCount, int64_t firstFrame,
+                                                 bool *isAboveThreshold) {
+    std::vector<int64_t> onsets;
+    for (int32_t i = 0; i < numFrames; ++i) {
+        const bool isAbove = output[i * channelCount] >= kOnsetThreshold;
+        if (isAbove && !*isAboveThreshold) {
+            onsets.push_back(firstFrame + i);
+        }
+        *isAboveThreshold = isAbove;
+    }
+    return onsets;
+}
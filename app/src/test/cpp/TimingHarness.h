@@ -0,0 +1,63 @@
+#ifndef METRONOMEPLUS_TIMINGHARNESS_H
+#define METRONOMEPLUS_TIMINGHARNESS_H
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "audio/DataSource.h"
+
+struct TimingConfig {
+    int bpm = 120;
+    int32_t sampleRate = 48000;
+    int64_t durationFrames = 48000 * 60;
+    // Burst sizes are drawn uniformly from [minBurstFrames, maxBurstFrames]
+    int32_t minBurstFrames = 192;
+    int32_t maxBurstFrames = 192;
+    uint32_t seed = 1;
+    // Every `skipIntervalFrames` the stream is reopened the way it is when switching performance
+    // mode: it is down for `skippedFrames` and whatever the old stream had not played yet is lost.
+    // 0 disables reopening.
+    int64_t skipIntervalFrames = 0;
+    int64_t skippedFrames = 0;
+    // Frames between rendering and hearing a frame. The streams alternate between the two.
+    int64_t outputLatencyFrames[2] = {0, 0};
+};
+
+struct TimingReport {
+    // Grid points that fall inside the rendered (not skipped) frames that were heard
+    int64_t expectedOnsets = 0;
+    int64_t detectedOnsets = 0;
+    double maxErrorFrames = 0;
+    double rmsErrorFrames = 0;
+    // Error of the last onset minus the error of the first one
+    double driftFrames = 0;
+};
+
+/**
+ * Drives a Sequencer the way the audio stream would, from a virtual clock that advances by a
+ * (possibly jittery) burst per callback. The rendered output is scanned for click onsets, which are
+ * compared against the nearest point of the ideal beat grid `n * sampleRate * 60 / bpm` at the
+ * time they are heard. The grid is anchored to the first stream, so a reopen that does not account
+ * for the change in output latency shows up as an error.
+ */
+class TimingHarness {
+
+public:
+    TimingHarness();
+
+    TimingReport run(const TimingConfig &config);
+
+    /**
+     * Returns the frames at which a click starts in `output`. A click starts when the first
+     * channel rises above the detection threshold after at least one frame below it.
+     */
+    static std::vector<int64_t> detectOnsets(const float *output, int32_t numFrames,
+                                             int32_t channelCount, int64_t firstFrame,
+                                             bool *isAboveThreshold);
+
+private:
+    std::shared_ptr<DataSource> mClick;
+};
+
+#endif //METRONOMEPLUS_TIMINGHARNESS_H
@@ -0,0 +1,385 @@
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "HostAudio.h"
+#include "analysis/TimingAnalyzer.h"
+#include "audio/BusRouter.h"
+#include "audio/ClickSynth.h"
+#include "audio/Limiter.h"
+#include "audio/Mixer.h"
+#include "audio/Player.h"
+#include "audio/SampleConversion.h"
+#include "audio/Sequencer.h"
+#include "model/Beat.h"
+
+namespace {
+
+std::shared_ptr<DataSource> beatSource() {
+    static std::shared_ptr<DataSource> source = loadAsset(kNormalBeat);
+    return source;
+}
+
+void setBurstArguments(benchmark::internal::Benchmark *benchmark) {
+    for (int64_t burst : {64, 192, 960, 4096}) {
+        benchmark->Arg(burst);
+    }
+}
+
+void BM_MixerRenderAudio(benchmark::State &state) {
+    const auto trackCount = static_cast<int>(state.range(0));
+    const auto numFrames = static_cast<int32_t>(state.range(1));
+
+    Mixer mixer;
+    mixer.setChannelCount(kChannelCount);
+    std::vector<std::unique_ptr<Player>> players;
+    for (int i = 0; i < trackCount; ++i) {
+        players.push_back(std::make_unique<Player>(beatSource()));
+        players.back()->setLooping(true);
+        players.back()->setPlaying(true);
+        mixer.addTrack(players.back().get());
+    }
+
+    std::vector<float> output(numFrames * kChannelCount);
+    for (auto _ : state) {
+        mixer.renderAudio(output.data(), numFrames);
+        benchmark::DoNotOptimize(output.data());
+    }
+    state.SetItemsProcessed(state.iterations() * numFrames);
+}
+BENCHMARK(BM_MixerRenderAudio)->ArgsProduct({{1, 3, 8, 32}, {64, 192, 960, 4096}});
+
+void BM_PlayerRenderAudioPlaying(benchmark::State &state) {
+    const auto numFrames = static_cast<int32_t>(state.range(0));
+
+    std::shared_ptr<DataSource> source = beatSource();
+    Player player(source);
+    player.setLooping(true);
+    player.setPlaying(true);
+
+    std::vector<float> output(numFrames * kChannelCount);
+    for (auto _ : state) {
+        player.renderAudio(output.data(), numFrames);
+        benchmark::DoNotOptimize(output.data());
+    }
+    state.SetItemsProcessed(state.iterations() * numFrames);
+    state.counters["resident_bytes"] = static_cast<double>(source->getSize() * sizeof(float));
+}
+BENCHMARK(BM_PlayerRenderAudioPlaying)->Apply(setBurstArguments);
+
+// Same sound kept as 16-bit PCM and converted while rendering
+void BM_PlayerRenderAudioPcm16(benchmark::State &state) {
+    const auto numFrames = static_cast<int32_t>(state.range(0));
+
+    std::shared_ptr<DataSource> source = loadAssetPcm16(kNormalBeat);
+    Player player(source);
+    player.setLooping(true);
+    player.setPlaying(true);
+
+    std::vector<float> output(numFrames * kChannelCount);
+    for (auto _ : state) {
+        player.renderAudio(output.data(), numFrames);
+        benchmark::DoNotOptimize(output.data());
+    }
+    state.SetItemsProcessed(state.iterations() * numFrames);
+    state.counters["resident_bytes"] = static_cast<double>(source->getSize() * sizeof(int16_t));
+}
+BENCHMARK(BM_PlayerRenderAudioPcm16)->Apply(setBurstArguments);
+
+// Every bundled sound playing at once, as with a full sound bank loaded: about 2.8 MB of samples
+// as floats and half that as 16-bit PCM, so the mix is bound by memory rather than arithmetic.
+template<typename Loader>
+void renderSoundBank(benchmark::State &state, Loader load) {
+    const auto numFrames = static_cast<int32_t>(state.range(0));
+
+    std::vector<std::unique_ptr<Player>> players;
+    Mixer mixer;
+    mixer.setChannelCount(kChannelCount);
+    int64_t residentBytes = 0;
+    for (const char *filename : kBundledBeats) {
+        std::shared_ptr<DataSource> source = load(filename, &residentBytes);
+        players.push_back(std::make_unique<Player>(source));
+        players.back()->setLooping(true);
+        players.back()->setPlaying(true);
+        mixer.addTrack(players.back().get());
+    }
+
+    std::vector<float> output(numFrames * kChannelCount);
+    for (auto _ : state) {
+        mixer.renderAudio(output.data(), numFrames);
+        benchmark::DoNotOptimize(output.data());
+    }
+    state.SetItemsProcessed(state.iterations() * numFrames);
+    state.counters["resident_bytes"] = static_cast<double>(residentBytes);
+}
+
+void BM_SoundBankFloat(benchmark::State &state) {
+    renderSoundBank(state, [](const char *filename, int64_t *residentBytes) {
+        std::shared_ptr<DataSource> source = loadAsset(filename);
+        *residentBytes += source->getSize() * sizeof(float);
+        return source;
+    });
+}
+BENCHMARK(BM_SoundBankFloat)->Apply(setBurstArguments);
+
+void BM_SoundBankPcm16(benchmark::State &state) {
+    renderSoundBank(state, [](const char *filename, int64_t *residentBytes) {
+        std::shared_ptr<DataSource> source = loadAssetPcm16(filename);
+        *residentBytes += source->getSize() * sizeof(int16_t);
+        return source;
+    });
+}
+BENCHMARK(BM_SoundBankPcm16)->Apply(setBurstArguments);
+
+void BM_PlayerRenderAudioIdle(benchmark::State &state) {
+    const auto numFrames = static_cast<int32_t>(state.range(0));
+
+    Player player(beatSource());
+
+    std::vector<float> output(numFrames * kChannelCount);
+    for (auto _ : state) {
+        player.renderAudio(output.data(), numFrames);
+        benchmark::DoNotOptimize(output.data());
+    }
+    state.SetItemsProcessed(state.iterations() * numFrames);
+}
+BENCHMARK(BM_PlayerRenderAudioIdle)->Apply(setBurstArguments);
+
+// Synthesizing the click in the callback against playing it back from memory, both retriggered as
+// soon as they end. The resident counter is what each keeps in memory per sound.
+void BM_ClickSynthRenderAudio(benchmark::State &state) {
+    const auto numFrames = static_cast<int32_t>(state.range(0));
+
+    ClickSynth synth(clickParameters(ClickVoice::Woodblock, BeatState::Accent),
+                     AudioProperties{kChannelCount, kSampleRate});
+
+    std::vector<float> output(numFrames * kChannelCount);
+    for (auto _ : state) {
+        if (!synth.isPlaying()) synth.setPlaying(true);
+        synth.renderAudio(output.data(), numFrames);
+        benchmark::DoNotOptimize(output.data());
+    }
+    state.SetItemsProcessed(state.iterations() * numFrames);
+    state.counters["resident_bytes"] = sizeof(ClickSynth);
+}
+BENCHMARK(BM_ClickSynthRenderAudio)->Apply(setBurstArguments);
+
+void BM_PlayerRenderAudioBakedClick(benchmark::State &state) {
+    const auto numFrames = static_cast<int32_t>(state.range(0));
+
+    std::shared_ptr<DataSource> baked =
+            ClickSynth(clickParameters(ClickVoice::Woodblock, BeatState::Accent),
+                       AudioProperties{kChannelCount, kSampleRate}).bake();
+    Player player(baked);
+    player.setLooping(true);
+    player.setPlaying(true);
+
+    std::vector<float> output(numFrames * kChannelCount);
+    for (auto _ : state) {
+        player.renderAudio(output.data(), numFrames);
+        benchmark::DoNotOptimize(output.data());
+    }
+    state.SetItemsProcessed(state.iterations() * numFrames);
+    state.counters["resident_bytes"] =
+            static_cast<double>(sizeof(Player) + baked->getSize() * sizeof(float));
+}
+BENCHMARK(BM_PlayerRenderAudioBakedClick)->Apply(setBurstArguments);
+
+// The limiter on a quiet block (bypassed after the peak scan) and on a block that is 6 dB over
+void BM_LimiterProcess(benchmark::State &state) {
+    const auto numFrames = static_cast<int32_t>(state.range(0));
+    const float amplitude = state.range(1) == 0 ? 0.5f : 2.0f;
+    const int32_t numSamples = numFrames * kChannelCount;
+
+    std::vector<float> input(numSamples);
+    for (int32_t i = 0; i < numSamples; ++i) {
+        input[i] = amplitude * static_cast<float>((i * 7919) % 2001 - 1000) / 1000;
+    }
+    std::vector<float> output(numSamples);
+
+    // A bypassed block is left as is, a limited one has to be restored every iteration
+    const bool isBypassed = amplitude <= kLimiterKnee;
+    Limiter limiter(kSampleRate);
+    limiter.setChannelCount(kChannelCount);
+    for (auto _ : state) {
+        if (!isBypassed) std::copy(input.begin(), input.end(), output.begin());
+        limiter.process(isBypassed ? input.data() : output.data(), numFrames);
+        benchmark::DoNotOptimize(output.data());
+    }
+    state.SetItemsProcessed(state.iterations() * numFrames);
+}
+BENCHMARK(BM_LimiterProcess)->ArgsProduct({{64, 192, 960, 4096}, {0, 1}});
+
+// Routes a stereo bus to the first and last output, which spans every channel of the frame
+void BM_BusRouterApply(benchmark::State &state) {
+    const auto channelCount = static_cast<int32_t>(state.range(0));
+    const auto numFrames = static_cast<int32_t>(state.range(1));
+
+    BusRouter router;
+    router.setOutputChannelCount(channelCount);
+    router.setRoute(Bus::Click, 0, channelCount - 1, 0.8f);
+    router.update();
+
+    std::vector<float> bus(static_cast<size_t>(numFrames * kBusChannelCount), 0.25f);
+    std::vector<float> output(static_cast<size_t>(numFrames * channelCount), 0.0f);
+    for (auto _ : state) {
+        router.apply(Bus::Click, bus.data(), output.data(), numFrames);
+        benchmark::DoNotOptimize(output.data());
+    }
+    state.SetItemsProcessed(state.iterations() * numFrames);
+}
+BENCHMARK(BM_BusRouterApply)->ArgsProduct({{1, 2, 4, 6, 8}, {192, 4096}});
+
+void BM_ClickSynthBake(benchmark::State &state) {
+    const auto voice = static_cast<ClickVoice>(state.range(0));
+
+    ClickSynth synth(clickParameters(voice, BeatState::Accent),
+                     AudioProperties{kChannelCount, kSampleRate});
+    for (auto _ : state) {
+        std::shared_ptr<DataSource> baked = synth.bake();
+        benchmark::DoNotOptimize(baked->getData());
+    }
+    state.SetItemsProcessed(state.iterations() * synth.getLengthFrames());
+}
+BENCHMARK(BM_ClickSynthBake)->DenseRange(0, 2);
+
+void BM_SequencerRenderAudio(benchmark::State &state) {
+    const auto numFrames = static_cast<int32_t>(state.range(0));
+
+    Mixer mixer;
+    mixer.setChannelCount(kChannelCount);
+    Player player(beatSource());
+    mixer.addTrack(&player);
+
+    // 400 BPM so most bursts contain an onset
+    Sequencer sequencer(mixer, kSampleRate);
+    sequencer.setPlayer(BeatState::Normal, &player);
+    sequencer.setBeats({{BeatState::Normal}});
+    sequencer.setBPM(400);
+    sequencer.start();
+
+    std::vector<float> output(numFrames * kChannelCount);
+    for (auto _ : state) {
+        sequencer.renderAudio(output.data(), numFrames);
+        benchmark::DoNotOptimize(output.data());
+    }
+    state.SetItemsProcessed(state.iterations() * numFrames);
+}
+BENCHMARK(BM_SequencerRenderAudio)->Apply(setBurstArguments);
+
+void BM_SequencerSetBeats(benchmark::State &state) {
+    const auto beatCount = static_cast<size_t>(state.range(0));
+
+    Mixer mixer;
+    Sequencer sequencer(mixer, kSampleRate);
+    std::vector<Beat> beats(beatCount, Beat{BeatState::Normal});
+    beats.front().stateDto = BeatState::Accent;
+
+    for (auto _ : state) {
+        sequencer.setBeats(beats);
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * beatCount);
+}
+BENCHMARK(BM_SequencerSetBeats)->RangeMultiplier(2)->Range(1, kMaxBeats);
+
+void BM_ConvertPcm16ToFloat(benchmark::State &state) {
+    const auto numSamples = static_cast<size_t>(state.range(0));
+
+    std::vector<int16_t> input(numSamples);
+    for (size_t i = 0; i < numSamples; ++i) {
+        input[i] = static_cast<int16_t>(i * 7919);
+    }
+    std::vector<float> output(numSamples);
+
+    for (auto _ : state) {
+        convertPcm16ToFloat(input.data(), output.data(), static_cast<int64_t>(numSamples));
+        benchmark::DoNotOptimize(output.data());
+    }
+    state.SetItemsProcessed(state.iterations() * numSamples);
+}
+BENCHMARK(BM_ConvertPcm16ToFloat)->RangeMultiplier(8)->Range(128, 1 << 19);
+
+void BM_TimingAnalyzerProcessInput(benchmark::State &state) {
+    const auto numFrames = static_cast<int32_t>(state.range(0));
+    const int64_t framesPerBeat = kSampleRate / 2;
+
+    // A mono recording of the normal beat played on every beat, over a faint noise floor
+    std::shared_ptr<DataSource> source = beatSource();
+    std::vector<float> input(static_cast<size_t>(framesPerBeat) * 8);
+    for (size_t i = 0; i < input.size(); ++i) {
+        input[i] = static_cast<float>(static_cast<int32_t>(i * 7919 % 2001) - 1000) * 1e-6f;
+        const int64_t noteFrame = static_cast<int64_t>(i) % framesPerBeat;
+        if (noteFrame < source->getSize() / kChannelCount) {
+            input[i] += source->getData()[noteFrame * kChannelCount];
+        }
+    }
+
+    TimingAnalyzer analyzer(kSampleRate);
+    int64_t position = 0;
+    int64_t nextBeatFrame = 0;
+    TimingResult result;
+
+    for (auto _ : state) {
+        const size_t offset = static_cast<size_t>(position) % (input.size() - numFrames);
+        while (nextBeatFrame < position + numFrames) {
+            analyzer.onBeat(nextBeatFrame);
+            nextBeatFrame += framesPerBeat;
+        }
+        analyzer.processInput(&input[offset], numFrames, position, position + numFrames);
+        position += numFrames;
+
+        while (analyzer.popResult(&result)) {
+            benchmark::DoNotOptimize(result);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * numFrames);
+}
+BENCHMARK(BM_TimingAnalyzerProcessInput)->Apply(setBurstArguments);
+
+// What the app does with each beat sound once the NDK extractor has decoded it to 16-bit PCM:
+// hand the samples to a Pcm16DataSource and convert them to float while a Player renders the
+// whole sound. The host decodes the WAV asset once up front in place of the extractor.
+void BM_Pcm16BeatSound(benchmark::State &state, const std::string &filename) {
+    const std::shared_ptr<Pcm16DataSource> decoded = loadAssetPcm16(filename);
+    if (decoded == nullptr) {
+        state.SkipWithError("Could not decode asset");
+        return;
+    }
+    const AudioProperties properties = decoded->getProperties();
+    const int64_t numSamples = decoded->getSize();
+    const int64_t numFrames = numSamples / properties.channelCount;
+
+    constexpr int32_t kBurstFrames = 192;
+    std::vector<float> output(kBurstFrames * properties.channelCount);
+    for (auto _ : state) {
+        std::unique_ptr<int16_t[]> samples(new int16_t[numSamples]);
+        std::copy(decoded->getPcm16Data(), decoded->getPcm16Data() + numSamples, samples.get());
+        Player player(std::make_shared<Pcm16DataSource>(std::move(samples), numSamples,
+                                                        properties));
+        player.setPlaying(true);
+        for (int64_t frame = 0; frame < numFrames; frame += kBurstFrames) {
+            player.renderAudio(output.data(), kBurstFrames);
+            benchmark::DoNotOptimize(output.data());
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * numFrames);
+}
+
+}
+
+int main(int argc, char **argv) {
+    for (const char *filename : kBundledBeats) {
+        benchmark::RegisterBenchmark((std::string("BM_Pcm16BeatSound/") + filename).c_str(),
+                                     BM_Pcm16BeatSound, std::string(filename));
+    }
+
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) return 1;
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}